@@ -0,0 +1,42 @@
+#include "../ssd.h"
+#include "../block_management.h"
+using namespace ssd;
+
+Garbage_Collector_Cost_Benefit::Garbage_Collector_Cost_Benefit()
+	:  Garbage_Collector_Greedy()
+{}
+
+Garbage_Collector_Cost_Benefit::Garbage_Collector_Cost_Benefit(Ssd* ssd, Block_manager_parent* bm)
+	:  Garbage_Collector_Greedy(ssd, bm)
+{}
+
+// A block without live pages gives free space at no cost, so it is taken right away
+Block* Garbage_Collector_Cost_Benefit::choose_gc_victim(int package_id, int die_id, int klass) const {
+	double best_score = -1;
+	long best_block = UNDEFINED;
+	int package = package_id == -1 ? 0 : package_id;
+	int num_packages = package_id == -1 ? SSD_SIZE : package_id + 1;
+	for (; package < num_packages; package++) {
+		int die = die_id == -1 ? 0 : die_id;
+		int num_dies = die_id == -1 ? PACKAGE_SIZE : die_id + 1;
+		for (; die < num_dies; die++) {
+			for (int bucket = get_lowest_bucket(package, die); bucket < BLOCK_SIZE; bucket++) {
+				long oldest = buckets[package][die][bucket];
+				if (oldest == UNDEFINED) {
+					continue;
+				}
+				if (bucket == 0) {
+					return get_block(oldest);
+				}
+				double utilization = bucket / (double) BLOCK_SIZE;
+				double age = current_time - bucket_entry_time[oldest];
+				double score = (1 - utilization) * age / (2 * utilization);
+				if (score > best_score) {
+					best_score = score;
+					best_block = oldest;
+				}
+			}
+		}
+	}
+	return best_block == UNDEFINED ? NULL : get_block(best_block);
+}
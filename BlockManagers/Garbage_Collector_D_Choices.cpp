@@ -0,0 +1,55 @@
+#include "../ssd.h"
+#include "../block_management.h"
+using namespace ssd;
+
+Garbage_Collector_D_Choices::Garbage_Collector_D_Choices()
+	:  Garbage_Collector_Greedy(),
+	   eligible_blocks(SSD_SIZE, vector<vector<long> >(PACKAGE_SIZE)),
+	   index_of_block(NUMBER_OF_ADDRESSABLE_BLOCKS(), UNDEFINED)
+{}
+
+Garbage_Collector_D_Choices::Garbage_Collector_D_Choices(Ssd* ssd, Block_manager_parent* bm)
+	:  Garbage_Collector_Greedy(ssd, bm),
+	   eligible_blocks(SSD_SIZE, vector<vector<long> >(PACKAGE_SIZE)),
+	   index_of_block(NUMBER_OF_ADDRESSABLE_BLOCKS(), UNDEFINED)
+{}
+
+void Garbage_Collector_D_Choices::register_eligible_block(long block_id) {
+	Address a = Address(block_id * BLOCK_SIZE, BLOCK);
+	vector<long>& lun = eligible_blocks[a.package][a.die];
+	index_of_block[block_id] = lun.size();
+	lun.push_back(block_id);
+}
+
+void Garbage_Collector_D_Choices::register_ineligible_block(long block_id) {
+	Address a = Address(block_id * BLOCK_SIZE, BLOCK);
+	vector<long>& lun = eligible_blocks[a.package][a.die];
+	int index = index_of_block[block_id];
+	lun[index] = lun.back();
+	index_of_block[lun[index]] = index;
+	lun.pop_back();
+	index_of_block[block_id] = UNDEFINED;
+}
+
+// The samples are drawn with replacement, so a LUN with few candidates may see the same one several times
+Block* Garbage_Collector_D_Choices::choose_gc_victim(int package_id, int die_id, int klass) const {
+	int min_valid_pages = BLOCK_SIZE;
+	long best_block = UNDEFINED;
+	int package = package_id == -1 ? 0 : package_id;
+	int num_packages = package_id == -1 ? SSD_SIZE : package_id + 1;
+	for (; package < num_packages; package++) {
+		int die = die_id == -1 ? 0 : die_id;
+		int num_dies = die_id == -1 ? PACKAGE_SIZE : die_id + 1;
+		for (; die < num_dies; die++) {
+			vector<long> const& lun = eligible_blocks[package][die];
+			for (int i = 0; i < GC_D_CHOICES && !lun.empty(); i++) {
+				long block_id = lun[rand() % lun.size()];
+				if (bucket_of_block[block_id] < min_valid_pages) {
+					min_valid_pages = bucket_of_block[block_id];
+					best_block = block_id;
+				}
+			}
+		}
+	}
+	return best_block == UNDEFINED ? NULL : get_block(best_block);
+}
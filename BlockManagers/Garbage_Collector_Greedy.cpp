@@ -4,66 +4,184 @@ using namespace ssd;
 
 Garbage_Collector_Greedy::Garbage_Collector_Greedy()
 	:  Garbage_Collector(),
-	   gc_candidates(SSD_SIZE, vector<set<long> >(PACKAGE_SIZE, set<long>()))
+	   buckets(SSD_SIZE, vector<vector<long> >(PACKAGE_SIZE, vector<long>(BLOCK_SIZE, UNDEFINED))),
+	   bucket_tails(SSD_SIZE, vector<vector<long> >(PACKAGE_SIZE, vector<long>(BLOCK_SIZE, UNDEFINED))),
+	   lowest_bucket(SSD_SIZE, vector<int>(PACKAGE_SIZE, BLOCK_SIZE)),
+	   num_candidates(SSD_SIZE, vector<int>(PACKAGE_SIZE, 0)),
+	   is_candidate(NUMBER_OF_ADDRESSABLE_BLOCKS(), false),
+	   is_victim(NUMBER_OF_ADDRESSABLE_BLOCKS(), false),
+	   bucket_of_block(NUMBER_OF_ADDRESSABLE_BLOCKS(), UNDEFINED),
+	   next_in_bucket(NUMBER_OF_ADDRESSABLE_BLOCKS(), UNDEFINED),
+	   prev_in_bucket(NUMBER_OF_ADDRESSABLE_BLOCKS(), UNDEFINED),
+	   bucket_entry_time(NUMBER_OF_ADDRESSABLE_BLOCKS(), 0),
+	   current_time(0)
 {}
 
 Garbage_Collector_Greedy::Garbage_Collector_Greedy(Ssd* ssd, Block_manager_parent* bm)
 	:  Garbage_Collector(ssd, bm),
-	   gc_candidates(SSD_SIZE, vector<set<long> >(PACKAGE_SIZE, set<long>()))
+	   buckets(SSD_SIZE, vector<vector<long> >(PACKAGE_SIZE, vector<long>(BLOCK_SIZE, UNDEFINED))),
+	   bucket_tails(SSD_SIZE, vector<vector<long> >(PACKAGE_SIZE, vector<long>(BLOCK_SIZE, UNDEFINED))),
+	   lowest_bucket(SSD_SIZE, vector<int>(PACKAGE_SIZE, BLOCK_SIZE)),
+	   num_candidates(SSD_SIZE, vector<int>(PACKAGE_SIZE, 0)),
+	   is_candidate(NUMBER_OF_ADDRESSABLE_BLOCKS(), false),
+	   is_victim(NUMBER_OF_ADDRESSABLE_BLOCKS(), false),
+	   bucket_of_block(NUMBER_OF_ADDRESSABLE_BLOCKS(), UNDEFINED),
+	   next_in_bucket(NUMBER_OF_ADDRESSABLE_BLOCKS(), UNDEFINED),
+	   prev_in_bucket(NUMBER_OF_ADDRESSABLE_BLOCKS(), UNDEFINED),
+	   bucket_entry_time(NUMBER_OF_ADDRESSABLE_BLOCKS(), 0),
+	   current_time(0)
 {}
 
+Block* Garbage_Collector_Greedy::get_block(long block_id) const {
+	Address a = Address(block_id * BLOCK_SIZE, BLOCK);
+	return ssd->get_package(a.package)->get_die(a.die)->get_plane(a.plane)->get_block(a.block);
+}
+
+void Garbage_Collector_Greedy::link(long block_id, int bucket, double time) {
+	Address a = Address(block_id * BLOCK_SIZE, BLOCK);
+	long& tail = bucket_tails[a.package][a.die][bucket];
+	prev_in_bucket[block_id] = tail;
+	next_in_bucket[block_id] = UNDEFINED;
+	if (tail == UNDEFINED) {
+		buckets[a.package][a.die][bucket] = block_id;
+	} else {
+		next_in_bucket[tail] = block_id;
+	}
+	tail = block_id;
+	bucket_of_block[block_id] = bucket;
+	bucket_entry_time[block_id] = time;
+	lowest_bucket[a.package][a.die] = min(lowest_bucket[a.package][a.die], bucket);
+}
+
+void Garbage_Collector_Greedy::unlink(long block_id) {
+	int bucket = bucket_of_block[block_id];
+	if (bucket == UNDEFINED) {
+		return;
+	}
+	Address a = Address(block_id * BLOCK_SIZE, BLOCK);
+	long next = next_in_bucket[block_id];
+	long prev = prev_in_bucket[block_id];
+	if (prev == UNDEFINED) {
+		buckets[a.package][a.die][bucket] = next;
+	} else {
+		next_in_bucket[prev] = next;
+	}
+	if (next == UNDEFINED) {
+		bucket_tails[a.package][a.die][bucket] = prev;
+	} else {
+		prev_in_bucket[next] = prev;
+	}
+	bucket_of_block[block_id] = UNDEFINED;
+	next_in_bucket[block_id] = UNDEFINED;
+	prev_in_bucket[block_id] = UNDEFINED;
+}
+
+// Moves the block to the bucket of its current number of live pages, or takes it out of the buckets
+// if it is no longer a candidate, or is not fully written, e.g. because it was erased and is being written again
+void Garbage_Collector_Greedy::update_candidate(long block_id, double time) {
+	Block* block = get_block(block_id);
+	int bucket = block->get_pages_valid();
+	bool is_eligible = is_candidate[block_id] && bucket < BLOCK_SIZE && (block->get_state() == ACTIVE || block->get_state() == INACTIVE);
+	bool was_eligible = bucket_of_block[block_id] != UNDEFINED;
+	if (is_eligible && bucket_of_block[block_id] == bucket) {
+		return;
+	}
+	unlink(block_id);
+	if (is_eligible) {
+		link(block_id, bucket, time);
+	}
+	if (is_eligible && !was_eligible) {
+		register_eligible_block(block_id);
+	} else if (!is_eligible && was_eligible) {
+		register_ineligible_block(block_id);
+	}
+}
+
+// A victim is not offered again until it has been erased, even though its pages keep being invalidated as they are moved
+void Garbage_Collector_Greedy::add_candidate(Address const& block, double time) {
+	long block_id = block.get_block_id();
+	if (is_victim[block_id]) {
+		return;
+	}
+	if (!is_candidate[block_id]) {
+		is_candidate[block_id] = true;
+		num_candidates[block.package][block.die]++;
+	}
+	update_candidate(block_id, time);
+}
+
 void Garbage_Collector_Greedy::commit_choice_of_victim(Address const& phys_address, double time) {
-	gc_candidates[phys_address.package][phys_address.die].erase(phys_address.get_linear_address());
+	long block_id = phys_address.get_block_id();
+	is_victim[block_id] = true;
+	if (!is_candidate[block_id]) {
+		return;
+	}
+	is_candidate[block_id] = false;
+	num_candidates[phys_address.package][phys_address.die]--;
+	update_candidate(block_id, time);
+}
+
+int Garbage_Collector_Greedy::get_lowest_bucket(int package, int die) const {
+	vector<long> const& lun = buckets[package][die];
+	int& lowest = lowest_bucket[package][die];
+	while (lowest < BLOCK_SIZE && lun[lowest] == UNDEFINED) {
+		lowest++;
+	}
+	return lowest;
 }
 
-vector<long> Garbage_Collector_Greedy::get_relevant_gc_candidates(int package_id, int die_id, int klass) const {
-	vector<long > candidates;
+// The best victim of a LUN is the head of its lowest non-empty bucket. The hint only moves up past buckets
+// that blocks have left since, so the scan is paid for by those moves.
+Block* Garbage_Collector_Greedy::choose_gc_victim(int package_id, int die_id, int klass) const {
+	int min_valid_pages = BLOCK_SIZE;
+	Block* best_block = NULL;
 	int package = package_id == -1 ? 0 : package_id;
 	int num_packages = package_id == -1 ? SSD_SIZE : package_id + 1;
 	for (; package < num_packages; package++) {
 		int die = die_id == -1 ? 0 : die_id;
 		int num_dies = die_id == -1 ? PACKAGE_SIZE : die_id + 1;
 		for (; die < num_dies; die++) {
-			for (auto i : gc_candidates[package][die]) {
-				candidates.push_back(i);
+			int lowest = get_lowest_bucket(package, die);
+			if (lowest < min_valid_pages) {
+				min_valid_pages = lowest;
+				best_block = get_block(buckets[package][die][lowest]);
 			}
 		}
 	}
-	return candidates;
-}
-
-Block* Garbage_Collector_Greedy::choose_gc_victim(int package_id, int die_id, int klass) const {
-	vector<long> candidates = get_relevant_gc_candidates(package_id, die_id, klass);
-	uint min_valid_pages = BLOCK_SIZE;
-	Block* best_block = NULL;
-	for (auto physical_address : candidates) {
-		Address a = Address(physical_address, BLOCK);
-		Block* block = ssd->get_package(a.package)->get_die(a.die)->get_plane(a.plane)->get_block(a.block);
-		if (block->get_pages_valid() < min_valid_pages && (block->get_state() == ACTIVE || block->get_state() == INACTIVE)) {
-			min_valid_pages = block->get_pages_valid();
-			best_block = block;
-			assert(min_valid_pages < BLOCK_SIZE);
-		}
-	}
-
 	return best_block;
 }
 
+// Writes fill up candidates that were still being written, and an erased candidate leaves the buckets until it is full again
 void Garbage_Collector_Greedy::register_event_completion(Event const& event) {
-	if (event.get_event_type() != WRITE) {
-		return;
+	current_time = max(current_time, event.get_current_time());
+	Address a = event.get_address();
+	if (event.get_event_type() == ERASE && a.valid >= BLOCK) {
+		is_victim[a.get_block_id()] = false;
+	}
+	if ((event.get_event_type() == WRITE || event.get_event_type() == COPY_BACK || event.get_event_type() == ERASE)
+			&& a.valid >= BLOCK && is_candidate[a.get_block_id()]) {
+		update_candidate(a.get_block_id(), event.get_current_time());
 	}
 	Address ra = event.get_replace_address();
-	if (ra.valid == NONE) {
+	if (ra.valid == NONE || (event.get_event_type() != WRITE && event.get_event_type() != TRIM)) {
+		return;
+	}
+	long block_id = ra.get_block_id();
+	if (event.get_event_type() == TRIM) {
+		if (is_candidate[block_id]) {
+			update_candidate(block_id, event.get_current_time());
+		}
 		return;
 	}
-	ra.valid = BLOCK;
-	ra.page = 0;
 	if (PRINT_LEVEL > 1) {
 		//printf("Inserting as GC candidate: %ld ", ra.get_linear_address()); ra.print(); printf(" with age_class %d and valid blocks: %d\n", num_live_pages);
 	}
-	gc_candidates[ra.package][ra.die].insert(ra.get_linear_address());
-	if (gc_candidates[ra.package][ra.die].size() == 1) {
+	add_candidate(ra, event.get_current_time());
+	if (num_candidates[ra.package][ra.die] == 1) {
 		bm->check_if_should_trigger_more_GC(event);
 	}
 }
+
+void Garbage_Collector_Greedy::register_trimmed_block(Address const& block, Event const& trim) {
+	add_candidate(block, trim.get_current_time());
+}
@@ -0,0 +1,72 @@
+#include "../ssd.h"
+#include "../block_management.h"
+using namespace ssd;
+
+Garbage_Collector_Windowed_Greedy::Garbage_Collector_Windowed_Greedy()
+	:  Garbage_Collector_Greedy(),
+	   fill_order_heads(SSD_SIZE, vector<long>(PACKAGE_SIZE, UNDEFINED)),
+	   fill_order_tails(SSD_SIZE, vector<long>(PACKAGE_SIZE, UNDEFINED)),
+	   next_filled(NUMBER_OF_ADDRESSABLE_BLOCKS(), UNDEFINED),
+	   prev_filled(NUMBER_OF_ADDRESSABLE_BLOCKS(), UNDEFINED)
+{}
+
+Garbage_Collector_Windowed_Greedy::Garbage_Collector_Windowed_Greedy(Ssd* ssd, Block_manager_parent* bm)
+	:  Garbage_Collector_Greedy(ssd, bm),
+	   fill_order_heads(SSD_SIZE, vector<long>(PACKAGE_SIZE, UNDEFINED)),
+	   fill_order_tails(SSD_SIZE, vector<long>(PACKAGE_SIZE, UNDEFINED)),
+	   next_filled(NUMBER_OF_ADDRESSABLE_BLOCKS(), UNDEFINED),
+	   prev_filled(NUMBER_OF_ADDRESSABLE_BLOCKS(), UNDEFINED)
+{}
+
+void Garbage_Collector_Windowed_Greedy::register_eligible_block(long block_id) {
+	Address a = Address(block_id * BLOCK_SIZE, BLOCK);
+	long& tail = fill_order_tails[a.package][a.die];
+	prev_filled[block_id] = tail;
+	next_filled[block_id] = UNDEFINED;
+	if (tail == UNDEFINED) {
+		fill_order_heads[a.package][a.die] = block_id;
+	} else {
+		next_filled[tail] = block_id;
+	}
+	tail = block_id;
+}
+
+void Garbage_Collector_Windowed_Greedy::register_ineligible_block(long block_id) {
+	Address a = Address(block_id * BLOCK_SIZE, BLOCK);
+	long next = next_filled[block_id];
+	long prev = prev_filled[block_id];
+	if (prev == UNDEFINED) {
+		fill_order_heads[a.package][a.die] = next;
+	} else {
+		next_filled[prev] = next;
+	}
+	if (next == UNDEFINED) {
+		fill_order_tails[a.package][a.die] = prev;
+	} else {
+		prev_filled[next] = prev;
+	}
+	next_filled[block_id] = UNDEFINED;
+	prev_filled[block_id] = UNDEFINED;
+}
+
+Block* Garbage_Collector_Windowed_Greedy::choose_gc_victim(int package_id, int die_id, int klass) const {
+	int window_size = GC_WINDOW_SIZE > 0 ? GC_WINDOW_SIZE : max(1, (int) (DIE_SIZE * PLANE_SIZE / 10));
+	int min_valid_pages = BLOCK_SIZE;
+	long best_block = UNDEFINED;
+	int package = package_id == -1 ? 0 : package_id;
+	int num_packages = package_id == -1 ? SSD_SIZE : package_id + 1;
+	for (; package < num_packages; package++) {
+		int die = die_id == -1 ? 0 : die_id;
+		int num_dies = die_id == -1 ? PACKAGE_SIZE : die_id + 1;
+		for (; die < num_dies; die++) {
+			long block_id = fill_order_heads[package][die];
+			for (int i = 0; i < window_size && block_id != UNDEFINED; i++, block_id = next_filled[block_id]) {
+				if (bucket_of_block[block_id] < min_valid_pages) {
+					min_valid_pages = bucket_of_block[block_id];
+					best_block = block_id;
+				}
+			}
+		}
+	}
+	return best_block == UNDEFINED ? NULL : get_block(best_block);
+}
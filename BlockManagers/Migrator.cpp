@@ -7,7 +7,19 @@ Migrator::Migrator() :
 		blocks_being_garbage_collected(),
 		num_erases_scheduled_per_package(SSD_SIZE),
 		dependent_gc(),
-		gc_time_stat()
+		gc_time_stat(),
+		num_merges(FULL_MERGE + 1, 0),
+		num_merge_page_copies(FULL_MERGE + 1, 0),
+		num_background_gcs(0),
+		num_background_gcs_yielded(0),
+		num_victim_selections(0),
+		victim_selection_cpu_time(0),
+		gc_paused_since(SSD_SIZE, vector<double>(PACKAGE_SIZE, UNDEFINED)),
+		num_gc_pauses(0),
+		num_gc_pauses_cut_short(0),
+		gc_pause_time(0),
+		num_concurrent_gcs(0),
+		max_concurrent_gcs_per_LUN(0)
 {
 }
 
@@ -24,6 +36,23 @@ Migrator::~Migrator() {
 		it++;
 	}*/
 	printf("average time for a whole GC operation:\t%f\n", StatisticData::get_average("gc_op_length", 0));
+	if (num_victim_selections > 0) {
+		printf("GC victim selections:\t%ld\n", num_victim_selections);
+		printf("CPU time per GC victim selection (us):\t%f\n", victim_selection_cpu_time * 1000000 / num_victim_selections);
+	}
+	if (BACKGROUND_GC_IDLE_TIME > 0) {
+		print_background_gc();
+	}
+	if (GC_LATENCY_BUDGET > 0) {
+		print_gc_pauses();
+	}
+	if (MAX_CONCURRENT_GC_OPS_PER_LUN > 1) {
+		printf("GC victims taken while their LUN was collecting another:\t%ld\n", num_concurrent_gcs);
+		printf("most GC victims on a LUN at once:\t%u\n", max_concurrent_gcs_per_LUN);
+	}
+	if (get_num_merges() > 0) {
+		print_merges();
+	}
 	delete gc;
 	delete wl;
 }
@@ -86,6 +115,11 @@ void Migrator::handle_erase_completion(Event* event) {
 		}
 		printf("\n");
 	}
+
+	// While the SSD stays idle, background GC goes on with the next block of the LUN
+	if (BACKGROUND_GC_IDLE_TIME > 0 && ssd->is_idle(event->get_current_time())) {
+		schedule_background_gc(event->get_current_time(), a.package, a.die);
+	}
 }
 
 void Migrator::handle_trim_completion(Event* event) {
@@ -125,10 +159,63 @@ void Migrator::handle_trim_completion(Event* event) {
 	}
 }
 
+// Invalidates the pages of a range trim. The pages are sorted by block, so that the garbage-collection state of each block
+// is updated once, however many of its pages the range covers.
+void Migrator::invalidate_pages(vector<Address>& pages, Event const& trim) {
+	sort(pages.begin(), pages.end());
+	uint i = 0;
+	while (i < pages.size()) {
+		Address ra = pages[i];
+		Block& block = *ssd->get_package(ra.package)->get_die(ra.die)->get_plane(ra.plane)->get_block(ra.block);
+		int num_invalidated = 0;
+		for (; i < pages.size() && pages[i].compare(ra) >= BLOCK; i++) {
+			assert(block.get_page(pages[i].page).get_state() == VALID);
+			block.invalidate_page(pages[i].page);
+			num_invalidated++;
+		}
+		assert(block.get_state() != FREE);
+		ra.valid = BLOCK;
+		ra.page = 0;
+
+		long const phys_addr = block.get_physical_address();
+		if (blocks_being_garbage_collected.count(phys_addr) == 1) {
+			assert(blocks_being_garbage_collected.at(phys_addr) >= num_invalidated);
+			blocks_being_garbage_collected.at(phys_addr) -= num_invalidated;
+			if (blocks_being_garbage_collected.at(phys_addr) == 0) {
+				assert(block.get_state() == INACTIVE);
+				blocks_being_garbage_collected[phys_addr]--;
+				issue_erase(ra, trim.get_current_time());
+			}
+		}
+		else {
+			gc->register_trimmed_block(ra, trim);
+		}
+	}
+}
+
 uint Migrator::how_many_gc_operations_are_scheduled() const {
 	return blocks_being_garbage_collected.size();
 }
 
+// A block whose erase has been issued has no pages left to move
+int Migrator::get_num_pages_left_to_migrate(int package, int die) const {
+	int num_pages = 0;
+	for (auto const& gc_op : blocks_being_garbage_collected) {
+		Address a = Address(gc_op.first, BLOCK);
+		if (a.package == package && a.die == die) {
+			num_pages += max(gc_op.second, 0);
+		}
+	}
+	return num_pages;
+}
+
+bool Migrator::is_being_garbage_collected(Address const& block) const {
+	Address a = block;
+	a.valid = BLOCK;
+	a.page = 0;
+	return blocks_being_garbage_collected.count(a.get_linear_address()) == 1;
+}
+
 void Migrator::issue_erase(Address ra, double time) {
 	ra.valid = BLOCK;
 	ra.page = 0;
@@ -163,7 +250,7 @@ void Migrator::issue_erase(Address ra, double time) {
 
 // schedules a garbage collection operation to occur at a given time, and optionally for a given channel, LUN or age class
 // the block to be reclaimed is chosen when the gc operation is initialised
-void Migrator::schedule_gc(double time, int package, int die, int block, int klass) {
+void Migrator::schedule_gc(double time, int package, int die, int block, int klass, bool background, bool wear_leveling) {
 	Event *gc_event = new Event(GARBAGE_COLLECTION, 0, BLOCK_SIZE, time);
 	Address address;
 	address.package = package;
@@ -178,8 +265,7 @@ void Migrator::schedule_gc(double time, int package, int die, int block, int kla
 		address.valid = DIE;
 	} else if (package >= 0 && die >= 0 && block >= 0) {
 		address.valid = BLOCK;
-		// TODO add the wear leveling as a parameter to this method
-		//gc_event->set_wear_leveling_op(true);
+		gc_event->set_wear_leveling_op(wear_leveling);
 	} else {
 		assert(false);
 	}
@@ -188,6 +274,7 @@ void Migrator::schedule_gc(double time, int package, int die, int block, int kla
 	gc_event->set_address(address);
 	gc_event->set_age_class(klass);
 	gc_event->set_garbage_collection_op(true);
+	gc_event->set_background_op(background);
 
 	if (PRINT_LEVEL > 1) {
 		//StateTracer::print();
@@ -217,12 +304,104 @@ void Migrator::register_ECC_check_on(uint logical_address) {
 	page_copy_back_count.erase(logical_address);
 }
 
+// A block with no live pages left is erased right away. Otherwise, it is erased once its last live page is invalidated.
 void Migrator::update_structures(Address const& a, double time) {
 	Block* victim = ssd->get_package(a.package)->get_die(a.die)->get_plane(a.plane)->get_block(a.block);
 	gc->commit_choice_of_victim(a, time);
 	blocks_being_garbage_collected[victim->get_physical_address()] = victim->get_pages_valid();
 	num_blocks_being_garbaged_collected_per_LUN[a.package][a.die]++;
 	StatisticsGatherer::get_global_instance()->register_executed_gc(*victim);
+	if (victim->get_pages_valid() == 0 && victim->get_state() == INACTIVE) {
+		blocks_being_garbage_collected[victim->get_physical_address()]--;
+		issue_erase(a, time);
+	}
+}
+
+// Each LUN below the high watermark gets a background GC operation at the given time,
+// which only goes ahead if the SSD is still idle by then
+void Migrator::schedule_background_gc(double time) {
+	for (uint i = 0; i < SSD_SIZE; i++) {
+		for (uint j = 0; j < PACKAGE_SIZE; j++) {
+			schedule_background_gc(time, i, j);
+		}
+	}
+}
+
+void Migrator::schedule_background_gc(double time, int package, int die) {
+	if (bm->get_num_free_blocks(package, die) < BACKGROUND_GC_FREE_BLOCKS && num_blocks_being_garbaged_collected_per_LUN[package][die] == 0) {
+		schedule_gc(time, package, die, UNDEFINED, UNDEFINED, true);
+	}
+}
+
+void Migrator::print_background_gc() const {
+	printf("background GC:\n");
+	printf("\tidle time before background GC (us):\t%f\n", BACKGROUND_GC_IDLE_TIME);
+	printf("\tfree blocks per LUN to clean up to:\t%d\n", BACKGROUND_GC_FREE_BLOCKS);
+	printf("\tblocks garbage-collected in the background:\t%ld\n", num_background_gcs);
+	printf("\tbackground GC operations dropped on host IO:\t%ld\n", num_background_gcs_yielded);
+}
+
+// The budget shrinks with the free blocks the LUN has left, so GC grows more urgent as space runs out and is never starved
+double Migrator::get_gc_latency_budget(int package, int die) const {
+	return GC_LATENCY_BUDGET * min(1.0, bm->get_num_free_blocks(package, die) / (double) max(GREED_SCALE, 1));
+}
+
+// GC on a LUN pauses between page migrations while host IOs wait for the LUN, until they are served or the LUN's budget runs out
+bool Migrator::should_pause_gc(Event const& gc_read) {
+	if (GC_LATENCY_BUDGET <= 0) {
+		return false;
+	}
+	Address const& a = gc_read.get_address();
+	double time = gc_read.get_current_time();
+	double& paused_since = gc_paused_since[a.package][a.die];
+	// Host writes that wait for free space wait for GC itself
+	bool host_io_waiting = scheduler->is_application_io_waiting_on(a, bm->get_num_pages_available_for_new_writes() > 0);
+	double budget = get_gc_latency_budget(a.package, a.die);
+	if (host_io_waiting && budget > 0 && (paused_since == UNDEFINED || time - paused_since < budget)) {
+		if (paused_since == UNDEFINED) {
+			paused_since = time;
+			num_gc_pauses++;
+		}
+		return true;
+	}
+	if (paused_since != UNDEFINED) {
+		gc_pause_time += time - paused_since;
+		num_gc_pauses_cut_short += host_io_waiting;
+		paused_since = UNDEFINED;
+	}
+	return false;
+}
+
+void Migrator::print_gc_pauses() const {
+	printf("preemptible GC:\n");
+	printf("\tlatency budget per LUN (us):\t%f\n", GC_LATENCY_BUDGET);
+	printf("\tGC pauses for host IO:\t%ld\n", num_gc_pauses);
+	printf("\tGC pauses cut short by the budget:\t%ld\n", num_gc_pauses_cut_short);
+	printf("\ttotal GC pause time (us):\t%f\n", gc_pause_time);
+	printf("\taverage GC pause (us):\t%f\n", num_gc_pauses == 0 ? 0 : gc_pause_time / num_gc_pauses);
+}
+
+void Migrator::register_merge(enum merge_type type, int num_page_copies) {
+	num_merges[type]++;
+	num_merge_page_copies[type] += num_page_copies;
+}
+
+long Migrator::get_num_merges() const {
+	return num_merges[SWITCH_MERGE] + num_merges[PARTIAL_MERGE] + num_merges[FULL_MERGE];
+}
+
+long Migrator::get_num_merge_page_copies() const {
+	return num_merge_page_copies[SWITCH_MERGE] + num_merge_page_copies[PARTIAL_MERGE] + num_merge_page_copies[FULL_MERGE];
+}
+
+void Migrator::print_merges() const {
+	const char* names[] = { "switch", "partial", "full" };
+	printf("merges:\n");
+	for (int type = SWITCH_MERGE; type <= FULL_MERGE; type++) {
+		printf("\t%s merges:\t%ld\n", names[type], num_merges[type]);
+		printf("\tpage copies in %s merges:\t%ld\n", names[type], num_merge_page_copies[type]);
+	}
+	printf("\tpage copies per merge:\t%f\n", get_num_merges() == 0 ? 0 : get_num_merge_page_copies() / (double) get_num_merges());
 }
 
 vector<deque<Event*> > Migrator::migrate(Event* gc_event) {
@@ -231,6 +410,13 @@ vector<deque<Event*> > Migrator::migrate(Event* gc_event) {
 	if (how_many_gc_operations_are_scheduled() >= MAX_CONCURRENT_GC_OPS) {
 		return migrations;
 	}
+	if (gc_event->is_background_op() && bm->get_num_free_blocks(a.package, a.die) >= BACKGROUND_GC_FREE_BLOCKS) {
+		return migrations;
+	}
+	if (gc_event->is_background_op() && !ssd->is_idle(gc_event->get_current_time())) {
+		num_background_gcs_yielded++;
+		return migrations;
+	}
 	/*bool scheduled_erase_successfully = schedule_queued_erase(a);
 	if (scheduled_erase_successfully) {
 		return migrations;
@@ -251,7 +437,10 @@ vector<deque<Event*> > Migrator::migrate(Event* gc_event) {
 		victim = ssd->get_package(a.package)->get_die(a.die)->get_plane(a.plane)->get_block(a.block);
 	}
 	else {
+		clock_t start = clock();
 		victim = gc->choose_gc_victim(package_id, die_id, gc_event->get_age_class());
+		victim_selection_cpu_time += double(clock() - start) / CLOCKS_PER_SEC;
+		num_victim_selections++;
 	}
 
 	StatisticsGatherer::get_global_instance()->register_scheduled_gc(*gc_event);
@@ -268,7 +457,20 @@ vector<deque<Event*> > Migrator::migrate(Event* gc_event) {
 
 	Address addr = Address(victim->get_physical_address(), BLOCK);
 
-	if (num_blocks_being_garbaged_collected_per_LUN[addr.package][addr.die] >= 1) {
+	// A LUN only takes a further victim once it has run out of free blocks, when one victim at a time cannot keep up.
+	// The live pages its victims have left to move must then fit in the GREED_SCALE free blocks a LUN keeps for GC,
+	// which bounds the free space concurrent GC reserves.
+	// A garbage collector may offer a block again before its erase has completed.
+	uint num_gcs_on_LUN = num_blocks_being_garbaged_collected_per_LUN[addr.package][addr.die];
+	bool may_take_another_victim = bm->get_num_free_blocks(addr.package, addr.die) == 0
+			&& get_num_pages_left_to_migrate(addr.package, addr.die) + victim->get_pages_valid() <= max(GREED_SCALE, 1) * BLOCK_SIZE;
+	if (num_gcs_on_LUN >= MAX_CONCURRENT_GC_OPS_PER_LUN || is_being_garbage_collected(addr) || (num_gcs_on_LUN > 0 && !may_take_another_victim)) {
+		StatisticsGatherer::get_global_instance()->num_gc_cancelled_gc_already_happening++;
+		return migrations;
+	}
+
+	// Wear leveling moves a whole block of live data, so it waits for a LUN that does not need its GC to make room
+	if (is_wear_leveling_op && bm->get_num_free_blocks(addr.package, addr.die) < GREED_SCALE) {
 		StatisticsGatherer::get_global_instance()->num_gc_cancelled_gc_already_happening++;
 		return migrations;
 	}
@@ -277,9 +479,9 @@ vector<deque<Event*> > Migrator::migrate(Event* gc_event) {
 		return migrations;
 	}*/
 
-	/*if (is_wear_leveling_op && !wl->schedule_wear_leveling_op(victim)) {
+	if (is_wear_leveling_op && !wl->schedule_wear_leveling_op(victim)) {
 		return migrations;
-	}*/
+	}
 
 	if (victim->get_physical_address() == 976 && gc_event->get_start_time() > 39548840) {
 		int i = 0;
@@ -301,6 +503,13 @@ vector<deque<Event*> > Migrator::migrate(Event* gc_event) {
 	}
 
 	update_structures(addr, gc_event->get_current_time());
+	if (gc_event->is_background_op()) {
+		num_background_gcs++;
+	}
+	if (num_gcs_on_LUN > 0) {
+		num_concurrent_gcs++;
+	}
+	max_concurrent_gcs_per_LUN = max(max_concurrent_gcs_per_LUN, num_blocks_being_garbaged_collected_per_LUN[addr.package][addr.die]);
 	//printf("blocks being gced %d\n", blocks_being_garbage_collected.size());
 	bm->subtract_from_available_for_new_writes(victim->get_pages_valid());
 
@@ -329,8 +538,8 @@ vector<deque<Event*> > Migrator::migrate(Event* gc_event) {
 
 	gc_time_stat[victim] = gc_event->get_current_time();
 
+	// update_structures has already issued the erase of a block with no live pages
 	if (victim->get_pages_invalid() == BLOCK_SIZE) {
-		issue_erase(addr, gc_event->get_current_time());
 		return migrations;
 	}
 
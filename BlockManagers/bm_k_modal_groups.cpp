@@ -58,8 +58,8 @@ void Block_Manager_Groups::init(Ssd* ssd, FtlParent* ftl, IOScheduler* sched, Ga
 	for (int i = 0; i < SSD_SIZE; i++) {
 		for (int j = 0; j < PACKAGE_SIZE; j++) {
 			Address a = free_block_pointers[i][j];
-			free_blocks[i][j][0].push_back(a);
 			free_block_pointers[i][j] = Address();
+			return_unfilled_block(a, 0, false);
 		}
 	}
 	assert(get_num_free_blocks() == SSD_SIZE * PACKAGE_SIZE * PLANE_SIZE);
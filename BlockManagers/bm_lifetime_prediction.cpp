@@ -0,0 +1,195 @@
+/*
+ * bm_lifetime_prediction.cpp
+ *
+ * A block manager that groups writes by when their data is predicted to be overwritten.
+ */
+
+#include <new>
+#include <assert.h>
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include "../ssd.h"
+
+using namespace ssd;
+
+#define LBA_HISTORY_WEIGHT 0.5 // the weight of the last rewrite interval of an LBA in the prediction of its next lifetime
+#define HINT_HISTORY_WEIGHT 0.125 // the weight of a lifetime in the average lifetime of its tag, stream or thread
+
+Block_Manager_Lifetime_Prediction::Block_Manager_Lifetime_Prediction()
+: Block_manager_parent(),
+  class_pointers(LIFETIME_CLASSES),
+  history(NUMBER_OF_ADDRESSABLE_PAGES()),
+  lifetime_per_hint(),
+  average_lifetime(UNDEFINED),
+  num_host_writes(0), num_gc_writes(0),
+  num_writes_per_class(LIFETIME_CLASSES + 1, 0),
+  num_predictions_checked(0), num_predictions_in_right_class(0),
+  sum_of_log_errors(0)
+{
+	for (auto& h : history) {
+		h.last_write = UNDEFINED;
+		h.predicted_lifetime = UNDEFINED;
+	}
+}
+
+Block_Manager_Lifetime_Prediction::~Block_Manager_Lifetime_Prediction() {
+	print();
+}
+
+// Tags and streams are set by the application for the data they label, so they are trusted over the thread that wrote it
+pair<int, int> Block_Manager_Lifetime_Prediction::get_hint(Event const& write) const {
+	if (write.get_tag() != UNDEFINED) {
+		return pair<int, int>(0, write.get_tag());
+	}
+	if (write.get_stream_id() != UNDEFINED) {
+		return pair<int, int>(1, write.get_stream_id());
+	}
+	return pair<int, int>(2, write.get_thread_id());
+}
+
+// The lifetime of a host write is predicted from the intervals at which its LBA has been rewritten. An LBA written
+// for the first time takes the average lifetime of its hint, or of all data. A page moved by GC has lived part of its
+// lifetime already. Once it outlives its prediction, it is expected to live about as long again. Returns UNDEFINED
+// if nothing is known about the data.
+double Block_Manager_Lifetime_Prediction::predict_lifetime(Event const& write) const {
+	long lba = write.get_logical_address();
+	bool has_history = lba >= 0 && lba < (long)history.size() && history[lba].last_write != UNDEFINED;
+	if (write.is_garbage_collection_op()) {
+		if (!has_history || history[lba].predicted_lifetime == UNDEFINED) {
+			return UNDEFINED;
+		}
+		double age = num_host_writes - history[lba].last_write;
+		return history[lba].predicted_lifetime > age ? history[lba].predicted_lifetime - age : max(age, 1.0);
+	}
+	if (has_history) {
+		double interval = max(num_host_writes - history[lba].last_write, 1L);
+		double last_prediction = history[lba].predicted_lifetime;
+		return last_prediction == UNDEFINED ? interval : (1 - LBA_HISTORY_WEIGHT) * last_prediction + LBA_HISTORY_WEIGHT * interval;
+	}
+	map<pair<int, int>, double>::const_iterator it = lifetime_per_hint.find(get_hint(write));
+	return it != lifetime_per_hint.end() ? (*it).second : average_lifetime;
+}
+
+int Block_Manager_Lifetime_Prediction::get_lifetime_class(double lifetime) const {
+	double logical_space = NUMBER_OF_ADDRESSABLE_PAGES() * OVER_PROVISIONING_FACTOR;
+	int halvings = ceil(log2(logical_space / lifetime)) - 1;
+	return LIFETIME_CLASSES - 1 - min(max(halvings, 0), LIFETIME_CLASSES - 1);
+}
+
+void Block_Manager_Lifetime_Prediction::open_lifetime_class(int lifetime_class, double time) {
+	class_pointers[lifetime_class] = vector<vector<Address> >(SSD_SIZE, vector<Address>(PACKAGE_SIZE));
+	for (int i = 0; i < SSD_SIZE; i++) {
+		for (int j = 0; j < PACKAGE_SIZE; j++) {
+			class_pointers[lifetime_class][i][j] = find_free_unused_block(i, j, time);
+		}
+	}
+}
+
+// Writes that nothing is known about, or whose class is out of space, go to the shared block pointers
+Address Block_Manager_Lifetime_Prediction::choose_best_address(Event& write) {
+	double lifetime = predict_lifetime(write);
+	if (lifetime == UNDEFINED) {
+		return get_free_block_pointer_with_shortest_IO_queue();
+	}
+	int lifetime_class = get_lifetime_class(lifetime);
+	if (class_pointers[lifetime_class].empty()) {
+		open_lifetime_class(lifetime_class, write.get_current_time());
+	}
+	pair<bool, pair<int, int> > result = find_soonest_free_block_pointer(class_pointers[lifetime_class]);
+	if (result.first) {
+		return class_pointers[lifetime_class][result.second.first][result.second.second];
+	}
+	return get_free_block_pointer_with_shortest_IO_queue();
+}
+
+Address Block_Manager_Lifetime_Prediction::choose_any_address(Event const& write) {
+	Address a = get_free_block_pointer_with_shortest_IO_queue();
+	if (has_free_pages(a)) {
+		return a;
+	}
+	for (auto const& pointers : class_pointers) {
+		for (uint i = 0; i < pointers.size(); i++) {
+			for (uint j = 0; j < pointers[i].size(); j++) {
+				if (has_free_pages(pointers[i][j])) {
+					return pointers[i][j];
+				}
+			}
+		}
+	}
+	return Address();
+}
+
+// A host write ends the lifetime of the data its LBA held, which is when the prediction made for that data is checked
+void Block_Manager_Lifetime_Prediction::register_write_outcome(Event const& event, enum status status) {
+	Block_manager_parent::register_write_outcome(event, status);
+	int p = event.get_address().package;
+	int d = event.get_address().die;
+	for (auto& pointers : class_pointers) {
+		if (!pointers.empty() && pointers[p][d].compare(event.get_address()) == PAGE) {
+			increment_pointer(pointers[p][d]);
+			if (!has_free_pages(pointers[p][d])) {
+				pointers[p][d] = find_free_unused_block(p, d, event.get_current_time());
+			}
+			break;
+		}
+	}
+
+	double predicted_lifetime = predict_lifetime(event);
+	num_writes_per_class[predicted_lifetime == UNDEFINED ? LIFETIME_CLASSES : get_lifetime_class(predicted_lifetime)]++;
+	if (event.is_garbage_collection_op()) {
+		num_gc_writes++;
+		return;
+	}
+	if (!event.is_original_application_io()) {
+		return;
+	}
+	long lba = event.get_logical_address();
+	if (lba >= 0 && lba < (long)history.size()) {
+		lba_history& h = history[lba];
+		if (h.last_write != UNDEFINED) {
+			double lifetime = max(num_host_writes - h.last_write, 1L);
+			if (h.predicted_lifetime != UNDEFINED) {
+				num_predictions_checked++;
+				if (get_lifetime_class(h.predicted_lifetime) == get_lifetime_class(lifetime)) {
+					num_predictions_in_right_class++;
+				}
+				sum_of_log_errors += fabs(log2(h.predicted_lifetime / lifetime));
+			}
+			double& hint_lifetime = lifetime_per_hint.insert(make_pair(get_hint(event), lifetime)).first->second;
+			hint_lifetime = (1 - HINT_HISTORY_WEIGHT) * hint_lifetime + HINT_HISTORY_WEIGHT * lifetime;
+			average_lifetime = average_lifetime == UNDEFINED ? lifetime : (1 - HINT_HISTORY_WEIGHT) * average_lifetime + HINT_HISTORY_WEIGHT * lifetime;
+		}
+		h.last_write = num_host_writes;
+		h.predicted_lifetime = predicted_lifetime;
+	}
+	num_host_writes++;
+}
+
+void Block_Manager_Lifetime_Prediction::register_erase_outcome(Event& event, enum status status) {
+	Block_manager_parent::register_erase_outcome(event, status);
+	int p = event.get_address().package;
+	int d = event.get_address().die;
+
+	for (auto& pointers : class_pointers) {
+		if (!pointers.empty() && !has_free_pages(pointers[p][d])) {
+			pointers[p][d] = find_free_unused_block(p, d, event.get_current_time());
+		}
+	}
+
+	if (!has_free_pages(free_block_pointers[p][d])) {
+		free_block_pointers[p][d] = find_free_unused_block(p, d, event.get_current_time());
+	}
+}
+
+void Block_Manager_Lifetime_Prediction::print() const {
+	printf("lifetime prediction:\n");
+	for (int i = 0; i < LIFETIME_CLASSES; i++) {
+		printf("\twrites in lifetime class %d:\t%ld\n", i, num_writes_per_class[i]);
+	}
+	printf("\twrites without a prediction:\t%ld\n", num_writes_per_class[LIFETIME_CLASSES]);
+	printf("\tpredictions checked:\t%ld\n", num_predictions_checked);
+	printf("\tpredictions in the right lifetime class:\t%f\n", num_predictions_checked == 0 ? 0 : num_predictions_in_right_class / (double) num_predictions_checked);
+	printf("\tmean log2 error of predicted lifetimes:\t%f\n", num_predictions_checked == 0 ? 0 : sum_of_log_errors / num_predictions_checked);
+	printf("\twrite amplification:\t%f\n", num_host_writes == 0 ? 0 : (num_host_writes + num_gc_writes) / (double) num_host_writes);
+}
@@ -21,14 +21,16 @@ Block_manager_parent::Block_manager_parent(int num_age_classes)
  : ssd(NULL),
    ftl(NULL),
    free_block_pointers(SSD_SIZE, vector<Address>(PACKAGE_SIZE)),
-   free_blocks(SSD_SIZE, vector<vector<deque<Address> > >(PACKAGE_SIZE, vector<deque<Address> >(num_age_classes, deque<Address>(0)) )),
+   free_blocks(),
    all_blocks(0),
    num_age_classes(num_age_classes),
    num_free_pages(SSD_SIZE * PACKAGE_SIZE * DIE_SIZE * PLANE_SIZE * BLOCK_SIZE),
    num_available_pages_for_new_writes(SSD_SIZE * PACKAGE_SIZE * DIE_SIZE * PLANE_SIZE * BLOCK_SIZE),
+   lun_availability(),
    IO_has_completed_since_last_shortest_queue_search(true),
    erase_queue(SSD_SIZE, queue< Event*>()),
    num_erases_scheduled_per_package(SSD_SIZE, 0),
+   wear_leveling_pointers(SSD_SIZE, vector<Address>(PACKAGE_SIZE)),
    scheduler(NULL),
    wl(NULL),
    gc(NULL),
@@ -51,19 +53,19 @@ void Block_manager_parent::init(Ssd* new_ssd, FtlParent* new_ftl, IOScheduler* n
 				Plane* plane = die->get_plane(t);
 				for (uint b = 0; b < PLANE_SIZE; b++) {
 					Block* block = plane->get_block(b);
-					free_blocks[i][j][0].push_back(Address(block->get_physical_address(), PAGE));
+					free_blocks.add(Address(block->get_physical_address(), PAGE), block->get_age());
 					all_blocks.push_back(block);
 				}
 			}
-			Address pointer = free_blocks[i][j][0].back();
+			Address pointer = free_blocks.take(i, j, YOUNG);
 			free_block_pointers[i][j] = pointer;
 			Free_Space_Per_LUN_Meter::mark_new_space(pointer, 0);
-			free_blocks[i][j][0].pop_back();
 		}
 	}
 	wl = new_wl;
 	gc = new_gc;
 	migrator = new_migrator;
+	lun_availability.init(ssd);
 }
 
 Address Block_manager_parent::choose_copbyback_address(Event const& write) {
@@ -78,6 +80,22 @@ Address Block_manager_parent::choose_copbyback_address(Event const& write) {
 	return has_free_pages(free_block_pointers[ra.package][ra.die]) ? free_block_pointers[ra.package][ra.die] : Address();
 }
 
+// Cold data moved by wear leveling is kept apart from the hot data, in the oldest free blocks there are.
+// The young block it leaves behind then takes hot data. Each LUN keeps a block open for it once it has been
+// wear-levelled, and the LUN with the shortest queue of those takes the write.
+Address Block_manager_parent::choose_wear_leveling_address(Event& write) {
+	Address ra = write.get_replace_address();
+	Address& pointer = wear_leveling_pointers[ra.package][ra.die];
+	if (!has_free_pages(pointer)) {
+		pointer = find_free_unused_block(ra.package, ra.die, OLD, write.get_current_time());
+	}
+	if (!has_free_pages(pointer)) {
+		return choose_best_address(write);
+	}
+	pair<bool, pair<int, int> > result = lun_availability.find_soonest(wear_leveling_pointers);
+	return result.first ? wear_leveling_pointers[result.second.first][result.second.second] : Address();
+}
+
 Address Block_manager_parent::choose_flexible_read_address(Flexible_Read_Event* fr) {
 	vector<vector<Address> > candidates = fr->get_candidates();
 	pair<bool, pair<int, int> > result = get_free_block_pointer_with_shortest_IO_queue(candidates);
@@ -100,6 +118,10 @@ Address Block_manager_parent::choose_write_address(Event& write) {
 		return choose_copbyback_address(write);
 	}
 
+	if (write.is_wear_leveling_op()) {
+		return choose_wear_leveling_address(write);
+	}
+
 	Address a = choose_best_address(write);
 	if (has_free_pages(a)) {
 		return a;
@@ -118,8 +140,6 @@ Address Block_manager_parent::choose_write_address(Event& write) {
 }
 
 void Block_manager_parent::register_erase_outcome(Event& event, enum status status) {
-	IO_has_completed_since_last_shortest_queue_search = true;
-
 	Address a = event.get_address();
 	a.valid = PAGE;
 	a.page = 0;
@@ -143,8 +163,7 @@ void Block_manager_parent::register_erase_outcome(Event& event, enum status stat
 		}
 	}
 
-	uint age_class = sort_into_age_class(a);
-	free_blocks[a.package][a.die][age_class].push_back(a);
+	free_blocks.add(a, ssd->get_package(a.package)->get_die(a.die)->get_plane(a.plane)->get_block(a.block)->get_age());
 
 	num_free_pages += BLOCK_SIZE;
 	num_available_pages_for_new_writes += BLOCK_SIZE;
@@ -163,7 +182,10 @@ void Block_manager_parent::register_write_arrival(Event const& write) {
 
 }
 
-void Block_manager_parent::register_register_cleared() {
+void Block_manager_parent::update_LUN_availability(Address const& lun) {
+	if (lun.valid >= DIE) {
+		lun_availability.update(lun.package, lun.die);
+	}
 	IO_has_completed_since_last_shortest_queue_search = true;
 }
 
@@ -182,8 +204,6 @@ void Block_manager_parent::increment_pointer(Address& pointer) {
 }
 
 void Block_manager_parent::register_write_outcome(Event const& event, enum status status) {
-	IO_has_completed_since_last_shortest_queue_search = true;
-
 	assert(num_free_pages > 0);
 	num_free_pages--;
 
@@ -201,6 +221,10 @@ void Block_manager_parent::register_write_outcome(Event const& event, enum statu
 	}
 
 	Address ba = event.get_address();
+	Address& wear_leveling_pointer = wear_leveling_pointers[ba.package][ba.die];
+	if (ba.compare(wear_leveling_pointer) >= BLOCK) {
+		increment_pointer(wear_leveling_pointer);
+	}
 	if (ba.compare(free_block_pointers[ba.package][ba.die]) >= BLOCK) {
 		increment_pointer(free_block_pointers[ba.package][ba.die]);
 		if (!has_free_pages(free_block_pointers[ba.package][ba.die])) {
@@ -227,7 +251,6 @@ void Block_manager_parent::register_write_outcome(Event const& event, enum statu
 }
 
 void Block_manager_parent::trim(Event const& event) {
-	IO_has_completed_since_last_shortest_queue_search = true;
 }
 
 int Block_manager_parent::get_num_pointers_with_free_space() const {
@@ -243,43 +266,22 @@ int Block_manager_parent::get_num_pointers_with_free_space() const {
 }
 
 int Block_manager_parent::get_num_free_blocks() const {
-	int sum = 0;
-	for (int i = 0; i < SSD_SIZE; i++) {
-		for (int j = 0; j < PACKAGE_SIZE; j++) {
-			sum += get_num_free_blocks(i, j);
-		}
-	}
-	return sum;
+	return free_blocks.get_num_free_blocks();
 }
 
 void Block_manager_parent::print_free_blocks() const {
-	for (int i = 0; i < SSD_SIZE; i++) {
-		for (int j = 0; j < PACKAGE_SIZE; j++) {
-			for (int k = 0; k < num_age_classes; k++) {
-				for (auto& q : free_blocks[i][j][k]) {
-					q.print();
-					printf("\n");
-				}
-			}
-		}
-	}
+	free_blocks.print();
 }
 
 int Block_manager_parent::get_num_free_blocks(int package, int die) const {
-	int num_free_blocks = 0;
-	for (int i = 0; i < num_age_classes; i++) {
-		num_free_blocks += free_blocks[package][die][i].size();
-	}
-	return num_free_blocks;
+	return free_blocks.get_num_free_blocks(package, die);
 }
 
 void Block_manager_parent::register_read_command_outcome(Event const& event, enum status status) {
-	IO_has_completed_since_last_shortest_queue_search = true;
 	assert(event.get_event_type() == READ_COMMAND);
 }
 
 void Block_manager_parent::register_read_transfer_outcome(Event const& event, enum status status) {
-	IO_has_completed_since_last_shortest_queue_search = true;
 	migrator->register_ECC_check_on(event.get_logical_address()); // An ECC check happens in a normal read-write GC operation
 	assert(event.get_event_type() == READ_TRANSFER);
 }
@@ -354,7 +356,7 @@ pair<bool, pair<int, int> > Block_manager_parent::get_free_block_pointer_with_sh
 Address Block_manager_parent::get_free_block_pointer_with_shortest_IO_queue() {
 	pair<bool, pair<int, int> > best_die;
 	if (IO_has_completed_since_last_shortest_queue_search) {
-	    best_die = get_free_block_pointer_with_shortest_IO_queue(free_block_pointers);
+		best_die = lun_availability.find_soonest(free_block_pointers);
 		last_get_free_block_pointer_with_shortest_IO_queue_result = best_die;
 		IO_has_completed_since_last_shortest_queue_search = false;
 	} else {
@@ -464,96 +466,44 @@ void Block_manager_parent::register_trim_making_gc_redundant(Event* trim) {
 
 // finds and returns a free block from anywhere in the SSD. Returns Address(0, NONE) is there is no such block
 Address Block_manager_parent::find_free_unused_block(double time) {
-	vector<int> order = Random_Order_Iterator::get_iterator(SSD_SIZE);
-	while (order.size() > 0) {
-		int index = order.back();
-		order.pop_back();
-		Address address = find_free_unused_block(index, time);
-		if (address.valid != NONE) {
-			return address;
-		}
-	}
-	return Address(0, NONE);
+	return find_free_unused_block(YOUNG, time);
 }
 
 Address Block_manager_parent::find_free_unused_block(uint package_id, double time) {
 	assert(package_id < SSD_SIZE);
-	vector<int> order = Random_Order_Iterator::get_iterator(PACKAGE_SIZE);
-	while (order.size() > 0) {
-		int index = order.back();
-		order.pop_back();
-		Address address = find_free_unused_block(package_id, index, time);
-		if (address.valid != NONE) {
-			return address;
-		}
+	pair<bool, pair<int, int> > lun = free_blocks.pick_random_LUN(package_id * PACKAGE_SIZE, (package_id + 1) * PACKAGE_SIZE);
+	if (lun.first) {
+		return find_free_unused_block(package_id, lun.second.second, time);
 	}
-	return Address(0, NONE);
-}
-
-// finds and returns a free block from a particular die in the SSD
-Address Block_manager_parent::find_free_unused_block(uint package_id, uint die_id, double time) {
-	assert(package_id < SSD_SIZE && die_id < PACKAGE_SIZE);
-	vector<int> order = Random_Order_Iterator::get_iterator(num_age_classes);
-	while (order.size() > 0) {
-		int index = order.back();
-		order.pop_back();
-		Address address = find_free_unused_block(package_id, die_id, index, time);
-		if (address.valid != NONE) {
-			return address;
-		}
+	for (uint die_id = 0; die_id < PACKAGE_SIZE; die_id++) {
+		migrator->schedule_gc(time, package_id, die_id, -1, -1);
 	}
 	return Address(0, NONE);
 }
 
-Address Block_manager_parent::find_free_unused_block(uint package_id, uint die_id, uint klass, double time) {
-	assert(package_id < SSD_SIZE && die_id < PACKAGE_SIZE && klass < num_age_classes);
-	Address to_return;
-	uint num_free_blocks_left = free_blocks[package_id][die_id][klass].size();
-	if (num_free_blocks_left > 0) {
-		to_return = free_blocks[package_id][die_id][klass].back();
-		free_blocks[package_id][die_id][klass].pop_back();
-		num_free_blocks_left--;
-		assert(has_free_pages(to_return));
-	}
-	if (to_return.valid != NONE &&  num_free_blocks_left == 0) {
-		//StateVisualiser::print_page_status();
-	}
-	if (num_free_blocks_left < GREED_SCALE) {
-		migrator->schedule_gc(time, package_id, die_id, -1, -1);
-	}
-	return to_return;
+// finds and returns a free block from a particular die in the SSD. The youngest one is taken, so that the most worn blocks rest.
+Address Block_manager_parent::find_free_unused_block(uint package_id, uint die_id, double time) {
+	return find_free_unused_block(package_id, die_id, YOUNG, time);
 }
 
 Address Block_manager_parent::find_free_unused_block(uint package, uint die, enum age age, double time) {
-	if (age == YOUNG) {
-		for (int i = 0; i < num_age_classes; i++) {
-			Address block = find_free_unused_block(package, die, i, time);
-			if (has_free_pages(block)) {
-				return block;
-			}
-		}
-	} else if (age == OLD) {
-		for (int i = num_age_classes - 1; i >= 0; i--) {
-			Address block = find_free_unused_block(package, die, i, time);
-			if (has_free_pages(block)) {
-				return block;
-			}
-		}
+	assert(package < SSD_SIZE && die < PACKAGE_SIZE);
+	Address to_return = free_blocks.take(package, die, age);
+	assert(to_return.valid == NONE || has_free_pages(to_return));
+	if (free_blocks.get_num_free_blocks(package, die) < GREED_SCALE) {
+		migrator->schedule_gc(time, package, die, -1, -1);
 	}
-	return Address();
+	return to_return;
 }
 
 Address Block_manager_parent::find_free_unused_block(enum age age, double time) {
-	vector<int> order1 = Random_Order_Iterator::get_iterator(SSD_SIZE);
-	for (uint i = 0; i < SSD_SIZE; i++) {
-		int package = order1[i];
-		vector<int> order2 = Random_Order_Iterator::get_iterator(PACKAGE_SIZE);
-		for (uint j = 0; j < PACKAGE_SIZE; j++) {
-			int die = order2[j];
-			Address block = find_free_unused_block(package, die, age, time);
-			if (has_free_pages(block)) {
-				return block;
-			}
+	pair<bool, pair<int, int> > lun = free_blocks.pick_random_LUN(0, SSD_SIZE * PACKAGE_SIZE);
+	if (lun.first) {
+		return find_free_unused_block(lun.second.first, lun.second.second, age, time);
+	}
+	for (uint package = 0; package < SSD_SIZE; package++) {
+		for (uint die = 0; die < PACKAGE_SIZE; die++) {
+			migrator->schedule_gc(time, package, die, -1, -1);
 		}
 	}
 	return Address();
@@ -561,9 +511,8 @@ Address Block_manager_parent::find_free_unused_block(enum age age, double time)
 
 void Block_manager_parent::return_unfilled_block(Address pba, double current_time, bool give_to_block_pointers) {
 	if (has_free_pages(pba)) {
-		int age_class = sort_into_age_class(pba);
 		if (!give_to_block_pointers || has_free_pages(free_block_pointers[pba.package][pba.die])) {
-			free_blocks[pba.package][pba.die][age_class].push_back(pba);
+			free_blocks.add(pba, ssd->get_package(pba.package)->get_die(pba.die)->get_plane(pba.plane)->get_block(pba.block)->get_age());
 		} else {
 			free_block_pointers[pba.package][pba.die] = pba;
 			Free_Space_Per_LUN_Meter::mark_new_space(pba, current_time);
@@ -571,6 +520,33 @@ void Block_manager_parent::return_unfilled_block(Address pba, double current_tim
 	}
 }
 
+// Puts a free block in SLC mode. The pages it cannot hold in SLC mode are taken out of the free space
+// until the block is erased. Returns Address(0, NONE) if there is no such block or too little free space.
+Address Block_manager_parent::find_free_unused_slc_block(uint package_id, uint die_id, double time) {
+	uint num_lost_pages = BLOCK_SIZE - BLOCK_SIZE / BITS_PER_CELL;
+	if (num_available_pages_for_new_writes <= num_lost_pages + BLOCK_SIZE) {
+		return Address();
+	}
+	Address a = find_free_unused_block(package_id, die_id, YOUNG, time);
+	if (has_free_pages(a)) {
+		Block* block = ssd->get_package(a.package)->get_die(a.die)->get_plane(a.plane)->get_block(a.block);
+		block->set_slc_mode(true);
+		num_free_pages -= num_lost_pages;
+		num_available_pages_for_new_writes -= num_lost_pages;
+		Free_Space_Meter::register_num_free_pages_for_app_writes(num_available_pages_for_new_writes, time);
+	}
+	return a;
+}
+
+// Used by FTLs that map blocks themselves. The pages a retired block leaves empty are taken out of the free space until it is erased.
+void Block_manager_parent::close_unfilled_block(Address const& a, double time) {
+	Block* block = ssd->get_package(a.package)->get_die(a.die)->get_plane(a.plane)->get_block(a.block);
+	uint num_lost_pages = block->invalidate_empty_pages();
+	num_free_pages -= num_lost_pages;
+	num_available_pages_for_new_writes -= num_lost_pages;
+	Free_Space_Meter::register_num_free_pages_for_app_writes(num_available_pages_for_new_writes, time);
+}
+
 void Block_manager_parent::copy_state(Block_manager_parent* bm) {
 	free_block_pointers = bm->free_block_pointers;
 	free_blocks = bm->free_blocks;
@@ -598,6 +574,10 @@ Block_manager_parent* Block_manager_parent::get_new_instance() {
 		case 5: bm = new Block_Manager_Tag_Groups(); break;
 		case 6: bm = new Block_Manager_Groups(); break;
 		case 7: bm = new bm_gc_locality(); break;
+		case 8: bm = new Block_Manager_Streams(); break;
+		case 9: bm = new Block_Manager_SLC_Cache(); break;
+		case 10: bm = new Block_Manager_Superblocks(); break;
+		case 11: bm = new Block_Manager_Lifetime_Prediction(); break;
 		default: bm = new Block_manager_parallel(); break;
 	}
 	return bm;
@@ -611,6 +591,181 @@ pointers::pointers(Block_manager_parent* bm) : bm(bm), blocks(SSD_SIZE, vector<A
 	}
 }
 
+Free_Block_Pools::Free_Block_Pools()
+	: pools(SSD_SIZE * PACKAGE_SIZE),
+	  num_free_blocks_per_LUN(SSD_SIZE * PACKAGE_SIZE, 0),
+	  luns_with_free_blocks((SSD_SIZE * PACKAGE_SIZE + 63) / 64, 0),
+	  num_free_blocks(0)
+{}
+
+void Free_Block_Pools::add(Address const& block, int age) {
+	uint lun = block.package * PACKAGE_SIZE + block.die;
+	pools[lun][age].push_back(block);
+	num_free_blocks_per_LUN[lun]++;
+	num_free_blocks++;
+	luns_with_free_blocks[lun / 64] |= 1ULL << (lun % 64);
+}
+
+// Returns Address(0, NONE) if the LUN has no free block
+Address Free_Block_Pools::take(uint package, uint die, enum age age) {
+	uint lun = package * PACKAGE_SIZE + die;
+	map<int, vector<Address> >& pool = pools[lun];
+	if (pool.empty()) {
+		return Address();
+	}
+	map<int, vector<Address> >::iterator bucket = age == YOUNG ? pool.begin() : --pool.end();
+	Address block = (*bucket).second.back();
+	(*bucket).second.pop_back();
+	if ((*bucket).second.empty()) {
+		pool.erase(bucket);
+	}
+	num_free_blocks--;
+	if (--num_free_blocks_per_LUN[lun] == 0) {
+		luns_with_free_blocks[lun / 64] &= ~(1ULL << (lun % 64));
+	}
+	return block;
+}
+
+// The bits of a word of the bitmap for the LUNs from first_lun up to end_lun
+unsigned long long Free_Block_Pools::get_bits(uint word, uint first_lun, uint end_lun) const {
+	unsigned long long bits = luns_with_free_blocks[word];
+	uint word_start = word * 64;
+	if (first_lun > word_start) {
+		bits &= ~0ULL << (first_lun - word_start);
+	}
+	if (end_lun < word_start + 64) {
+		bits &= (1ULL << (end_lun - word_start)) - 1;
+	}
+	return bits;
+}
+
+// Picks a LUN with free blocks at random among the LUNs from first_lun up to end_lun, which are numbered across dies first
+pair<bool, pair<int, int> > Free_Block_Pools::pick_random_LUN(uint first_lun, uint end_lun) const {
+	uint num_candidates = 0;
+	for (uint word = first_lun / 64; word <= (end_lun - 1) / 64; word++) {
+		num_candidates += __builtin_popcountll(get_bits(word, first_lun, end_lun));
+	}
+	if (num_candidates == 0) {
+		return pair<bool, pair<int, int> >(false, pair<int, int>(UNDEFINED, UNDEFINED));
+	}
+	uint rank = Random_Order_Iterator::get_random_index(num_candidates);
+	for (uint word = first_lun / 64; ; word++) {
+		unsigned long long bits = get_bits(word, first_lun, end_lun);
+		uint num_bits = __builtin_popcountll(bits);
+		if (rank >= num_bits) {
+			rank -= num_bits;
+			continue;
+		}
+		for (; rank > 0; rank--) {
+			bits &= bits - 1;
+		}
+		uint lun = word * 64 + __builtin_ctzll(bits);
+		return pair<bool, pair<int, int> >(true, pair<int, int>(lun / PACKAGE_SIZE, lun % PACKAGE_SIZE));
+	}
+}
+
+void Free_Block_Pools::print() const {
+	for (uint lun = 0; lun < pools.size(); lun++) {
+		for (map<int, vector<Address> >::const_iterator it = pools[lun].begin(); it != pools[lun].end(); it++) {
+			for (auto& block : (*it).second) {
+				block.print();
+				printf("  age %d\n", (*it).first);
+			}
+		}
+	}
+}
+
+LUN_Availability_Tree::LUN_Availability_Tree()
+	: ssd(NULL),
+	  num_package_leaves(1),
+	  num_die_leaves(1),
+	  package_tree(),
+	  die_trees()
+{}
+
+// The leaves are padded to a power of two with keys that never win
+void LUN_Availability_Tree::init(Ssd* new_ssd) {
+	ssd = new_ssd;
+	while (num_package_leaves < SSD_SIZE) {
+		num_package_leaves *= 2;
+	}
+	while (num_die_leaves < PACKAGE_SIZE) {
+		num_die_leaves *= 2;
+	}
+	double never = numeric_limits<double>::infinity();
+	package_tree = vector<pair<double, double> >(2 * num_package_leaves, pair<double, double>(never, never));
+	die_trees = vector<vector<double> >(SSD_SIZE, vector<double>(2 * num_die_leaves, never));
+	for (uint i = 0; i < SSD_SIZE; i++) {
+		for (uint j = 0; j < PACKAGE_SIZE; j++) {
+			update(i, j);
+		}
+	}
+}
+
+double LUN_Availability_Tree::get_die_key(uint package, uint die) const {
+	Die* d = ssd->get_package(package)->get_die(die);
+	return d->register_is_busy() ? numeric_limits<double>::infinity() : d->get_currently_executing_io_finish_time();
+}
+
+void LUN_Availability_Tree::update(uint package, uint die) {
+	vector<double>& dies = die_trees[package];
+	uint node = num_die_leaves + die;
+	dies[node] = get_die_key(package, die);
+	for (node /= 2; node > 0; node /= 2) {
+		dies[node] = min(dies[2 * node], dies[2 * node + 1]);
+	}
+	node = num_package_leaves + package;
+	package_tree[node] = pair<double, double>(max(ssd->get_currently_executing_operation_finish_time(package), dies[1]), dies[1]);
+	for (node /= 2; node > 0; node /= 2) {
+		package_tree[node] = min(package_tree[2 * node], package_tree[2 * node + 1]);
+	}
+}
+
+// Finds the LUN that can start a write the soonest among those whose pointer has free pages, indexed by package and die.
+// The trees are searched depth first, the sooner child first, and a subtree is left out once it cannot beat the best
+// LUN found so far. Usually the soonest LUN of all qualifies and the search takes O(log LUNs). A LUN whose pointer is
+// full costs O(log LUNs) more to skip.
+pair<bool, pair<int, int> > LUN_Availability_Tree::find_soonest(vector<vector<Address> > const& lun_pointers) const {
+	pair<double, double> best_key(numeric_limits<double>::infinity(), numeric_limits<double>::infinity());
+	pair<int, int> best(UNDEFINED, UNDEFINED);
+	search_packages(1, lun_pointers, best_key, best);
+	return pair<bool, pair<int, int> >(best.first != UNDEFINED, best);
+}
+
+void LUN_Availability_Tree::search_packages(uint node, vector<vector<Address> > const& lun_pointers, pair<double, double>& best_key, pair<int, int>& best) const {
+	if (!(package_tree[node] < best_key)) {
+		return;
+	}
+	if (node >= num_package_leaves) {
+		uint package = node - num_package_leaves;
+		search_dies(package, 1, ssd->get_currently_executing_operation_finish_time(package), lun_pointers, best_key, best);
+		return;
+	}
+	uint sooner = package_tree[2 * node] <= package_tree[2 * node + 1] ? 2 * node : 2 * node + 1;
+	search_packages(sooner, lun_pointers, best_key, best);
+	search_packages(sooner ^ 1, lun_pointers, best_key, best);
+}
+
+void LUN_Availability_Tree::search_dies(uint package, uint node, double channel_finish_time, vector<vector<Address> > const& lun_pointers, pair<double, double>& best_key, pair<int, int>& best) const {
+	vector<double> const& dies = die_trees[package];
+	pair<double, double> key(max(channel_finish_time, dies[node]), dies[node]);
+	if (!(key < best_key)) {
+		return;
+	}
+	if (node >= num_die_leaves) {
+		uint die = node - num_die_leaves;
+		Address const& pointer = lun_pointers[package][die];
+		if (pointer.valid == PAGE && pointer.page < BLOCK_SIZE) {
+			best_key = key;
+			best = pair<int, int>(package, die);
+		}
+		return;
+	}
+	uint sooner = dies[2 * node] <= dies[2 * node + 1] ? 2 * node : 2 * node + 1;
+	search_dies(package, sooner, channel_finish_time, lun_pointers, best_key, best);
+	search_dies(package, sooner ^ 1, channel_finish_time, lun_pointers, best_key, best);
+}
+
 pointers::pointers() : bm(NULL), blocks(SSD_SIZE, vector<Address>(PACKAGE_SIZE, Address())) {
 }
 
@@ -0,0 +1,161 @@
+/*
+ * bm_slc_cache.cpp
+ *
+ * A block manager that absorbs application writes in a pseudo-SLC cache and folds them into native blocks later.
+ */
+
+#include <new>
+#include <assert.h>
+#include <stdio.h>
+#include <algorithm>
+#include "../ssd.h"
+
+using namespace ssd;
+
+Block_Manager_SLC_Cache::Block_Manager_SLC_Cache()
+: Block_manager_parent(),
+  slc_pointers(SSD_SIZE, vector<Address>(PACKAGE_SIZE)),
+  full_slc_blocks(SSD_SIZE, vector<deque<Address> >(PACKAGE_SIZE)),
+  num_slc_writes(0), num_direct_writes(0), num_folded_pages(0),
+  num_slc_blocks_filled(0), num_slc_blocks_reclaimed(0)
+{}
+
+Block_Manager_SLC_Cache::~Block_Manager_SLC_Cache() {
+	print();
+}
+
+void Block_Manager_SLC_Cache::init(Ssd* ssd, FtlParent* ftl, IOScheduler* sched, Garbage_Collector* gc, Wear_Leveling_Strategy* wl, Migrator* migrator) {
+	Block_manager_parent::init(ssd, ftl, sched, gc, wl, migrator);
+	for (uint i = 0; i < SSD_SIZE; i++) {
+		for (uint j = 0; j < PACKAGE_SIZE; j++) {
+			open_slc_block(i, j, 0);
+		}
+	}
+}
+
+Block* Block_Manager_SLC_Cache::get_block(Address const& a) const {
+	return ssd->get_package(a.package)->get_die(a.die)->get_plane(a.plane)->get_block(a.block);
+}
+
+// The number of SLC blocks, open or full, that a LUN may hold
+int Block_Manager_SLC_Cache::get_cache_budget(int package, int die) const {
+	int budget = SLC_CACHE_SIZE * DIE_SIZE * PLANE_SIZE;
+	if (SLC_CACHE_DYNAMIC) {
+		budget += max(get_num_free_blocks(package, die) - 2 * GREED_SCALE, 0) / 2;
+	}
+	return max(budget, 1);
+}
+
+// A new SLC block is only opened if the cache has room and the LUN keeps enough free blocks for GC
+void Block_Manager_SLC_Cache::open_slc_block(int package, int die, double time) {
+	slc_pointers[package][die] = Address();
+	int num_slc_blocks = full_slc_blocks[package][die].size() + 1;
+	if (num_slc_blocks > get_cache_budget(package, die) || get_num_free_blocks(package, die) <= GREED_SCALE) {
+		return;
+	}
+	slc_pointers[package][die] = find_free_unused_slc_block(package, die, time);
+}
+
+// Folding is garbage collection of the oldest full SLC block, whose live pages the migrator moves to native blocks
+void Block_Manager_SLC_Cache::try_to_fold(int package, int die, double time) {
+	deque<Address> const& full_blocks = full_slc_blocks[package][die];
+	if (full_blocks.empty() || full_blocks.size() < SLC_FOLDING_THRESHOLD * get_cache_budget(package, die)) {
+		return;
+	}
+	Address victim = full_blocks.front();
+	if (!migrator->is_being_garbage_collected(victim)) {
+		migrator->schedule_gc(time, package, die, victim.block, UNDEFINED);
+	}
+}
+
+void Block_Manager_SLC_Cache::register_write_outcome(Event const& event, enum status status) {
+	Address ba = event.get_address();
+	if (!event.is_garbage_collection_op() && get_block(ba)->is_slc_mode()) {
+		num_slc_writes++;
+	} else if (!event.is_garbage_collection_op()) {
+		num_direct_writes++;
+	} else if (event.get_replace_address().valid == PAGE && get_block(event.get_replace_address())->is_slc_mode()) {
+		num_folded_pages++;
+	}
+	Block_manager_parent::register_write_outcome(event, status);
+
+	Address& slc_pointer = slc_pointers[ba.package][ba.die];
+	if (slc_pointer.valid != PAGE || ba.compare(slc_pointer) < BLOCK) {
+		return;
+	}
+	increment_pointer(slc_pointer);
+	if (slc_pointer.page < get_block(slc_pointer)->get_capacity()) {
+		return;
+	}
+	Address full_block = slc_pointer;
+	full_block.valid = BLOCK;
+	full_block.page = 0;
+	full_slc_blocks[ba.package][ba.die].push_back(full_block);
+	num_slc_blocks_filled++;
+	open_slc_block(ba.package, ba.die, event.get_current_time());
+	try_to_fold(ba.package, ba.die, event.get_current_time());
+}
+
+// An erase may free up room in the cache, or let a LUN whose earlier fold was turned down by the migrator try again
+void Block_Manager_SLC_Cache::register_erase_outcome(Event& event, enum status status) {
+	Block_manager_parent::register_erase_outcome(event, status);
+	Address a = event.get_address();
+
+	deque<Address>& full_blocks = full_slc_blocks[a.package][a.die];
+	for (deque<Address>::iterator it = full_blocks.begin(); it != full_blocks.end(); it++) {
+		if ((*it).compare(a) >= BLOCK) {
+			full_blocks.erase(it);
+			num_slc_blocks_reclaimed++;
+			break;
+		}
+	}
+
+	if (!has_free_pages(free_block_pointers[a.package][a.die])) {
+		free_block_pointers[a.package][a.die] = find_free_unused_block(a.package, a.die, event.get_current_time());
+		if (has_free_pages(free_block_pointers[a.package][a.die])) {
+			Free_Space_Per_LUN_Meter::mark_new_space(a, event.get_current_time());
+		}
+	}
+	if (slc_pointers[a.package][a.die].valid != PAGE) {
+		open_slc_block(a.package, a.die, event.get_current_time());
+	}
+
+	for (uint i = 0; i < SSD_SIZE; i++) {
+		for (uint j = 0; j < PACKAGE_SIZE; j++) {
+			try_to_fold(i, j, event.get_current_time());
+		}
+	}
+}
+
+// GC writes, including folding, always go to native blocks
+Address Block_Manager_SLC_Cache::choose_best_address(Event& write) {
+	if (!write.is_garbage_collection_op()) {
+		pair<bool, pair<int, int> > result = get_free_block_pointer_with_shortest_IO_queue(slc_pointers);
+		if (result.first) {
+			return slc_pointers[result.second.first][result.second.second];
+		}
+	}
+	return get_free_block_pointer_with_shortest_IO_queue();
+}
+
+Address Block_Manager_SLC_Cache::choose_any_address(Event const& write) {
+	return get_free_block_pointer_with_shortest_IO_queue();
+}
+
+void Block_Manager_SLC_Cache::print() const {
+	long num_full_slc_blocks = 0;
+	for (uint i = 0; i < SSD_SIZE; i++) {
+		for (uint j = 0; j < PACKAGE_SIZE; j++) {
+			num_full_slc_blocks += full_slc_blocks[i][j].size();
+		}
+	}
+	printf("SLC cache:\n");
+	printf("\tbudget per LUN (blocks):\t%d\n", get_cache_budget(0, 0));
+	printf("\twrites to SLC:\t%ld\n", num_slc_writes);
+	printf("\twrites straight to native blocks:\t%ld\n", num_direct_writes);
+	printf("\tSLC hit ratio:\t%f\n", num_slc_writes + num_direct_writes == 0 ? 0 : num_slc_writes / (double)(num_slc_writes + num_direct_writes));
+	printf("\tSLC blocks filled:\t%ld\n", num_slc_blocks_filled);
+	printf("\tSLC blocks reclaimed:\t%ld\n", num_slc_blocks_reclaimed);
+	printf("\tfull SLC blocks now:\t%ld\n", num_full_slc_blocks);
+	printf("\tpages folded:\t%ld\n", num_folded_pages);
+}
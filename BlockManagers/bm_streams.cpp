@@ -0,0 +1,150 @@
+/*
+ * bm_streams.cpp
+ *
+ * A block manager that honours the write stream hints given by the host.
+ */
+
+#include <new>
+#include <assert.h>
+#include <stdio.h>
+#include <algorithm>
+#include "../ssd.h"
+
+using namespace ssd;
+
+Block_Manager_Streams::Block_Manager_Streams()
+: Block_manager_parent(),
+  stream_pointers(),
+  open_streams(),
+  stream_of_lba(),
+  num_stream_evictions(0)
+{}
+
+void Block_Manager_Streams::register_write_arrival(Event const& e) {
+	int stream = e.get_stream_id();
+	if (stream == UNDEFINED) {
+		return;
+	}
+	deque<int>::iterator it = find(open_streams.begin(), open_streams.end(), stream);
+	if (it != open_streams.end()) {
+		open_streams.erase(it);
+		open_streams.push_front(stream);
+		return;
+	}
+	if (open_streams.size() >= MAX_OPEN_STREAMS) {
+		close_stream(open_streams.back(), e.get_current_time());
+	}
+	open_stream(stream, e.get_current_time());
+}
+
+void Block_Manager_Streams::open_stream(int stream, double time) {
+	stream_pointers[stream] = vector<vector<Address> >(SSD_SIZE, vector<Address>(PACKAGE_SIZE));
+	for (int i = 0; i < SSD_SIZE; i++) {
+		for (int j = 0; j < PACKAGE_SIZE; j++) {
+			stream_pointers.at(stream)[i][j] = find_free_unused_block(i, j, time);
+		}
+	}
+	open_streams.push_front(stream);
+}
+
+// The partially written blocks of a closed stream are given back, so that other writes can fill them up
+void Block_Manager_Streams::close_stream(int stream, double time) {
+	for (int i = 0; i < SSD_SIZE; i++) {
+		for (int j = 0; j < PACKAGE_SIZE; j++) {
+			return_unfilled_block(stream_pointers.at(stream)[i][j], time, false);
+		}
+	}
+	stream_pointers.erase(stream);
+	open_streams.erase(find(open_streams.begin(), open_streams.end(), stream));
+	num_stream_evictions++;
+}
+
+void Block_Manager_Streams::register_write_outcome(Event const& event, enum status status) {
+	Block_manager_parent::register_write_outcome(event, status);
+	if (event.is_original_application_io()) {
+		if (event.get_stream_id() == UNDEFINED) {
+			stream_of_lba.erase(event.get_logical_address());
+		} else {
+			stream_of_lba[event.get_logical_address()] = event.get_stream_id();
+		}
+	}
+
+	int p = event.get_address().package;
+	int d = event.get_address().die;
+	for (auto& s : stream_pointers) {
+		Address& block = s.second[p][d];
+		if (block.compare(event.get_address()) == PAGE) {
+			increment_pointer(block);
+			if (!has_free_pages(block)) {
+				block = find_free_unused_block(p, d, event.get_current_time());
+			}
+			return;
+		}
+	}
+}
+
+void Block_Manager_Streams::register_erase_outcome(Event& event, enum status status) {
+	Block_manager_parent::register_erase_outcome(event, status);
+	int p = event.get_address().package;
+	int d = event.get_address().die;
+
+	for (auto& s : stream_pointers) {
+		if (!has_free_pages(s.second[p][d])) {
+			s.second[p][d] = find_free_unused_block(p, d, event.get_current_time());
+		}
+	}
+
+	if (!has_free_pages(free_block_pointers[p][d])) {
+		free_block_pointers[p][d] = find_free_unused_block(p, d, event.get_current_time());
+	}
+}
+
+// Writes of streams that are not open, or whose blocks are out of space, go to the shared block pointers
+Address Block_Manager_Streams::choose_best_address(Event& write) {
+	int stream = write.get_stream_id();
+	if (stream == UNDEFINED && write.is_garbage_collection_op() && stream_of_lba.count(write.get_logical_address()) == 1) {
+		stream = stream_of_lba.at(write.get_logical_address());
+		write.set_stream_id(stream);
+	}
+
+	if (stream == UNDEFINED || stream_pointers.count(stream) == 0) {
+		return get_free_block_pointer_with_shortest_IO_queue();
+	}
+
+	pair<bool, pair<int, int> > result = get_free_block_pointer_with_shortest_IO_queue(stream_pointers.at(stream));
+	if (result.first) {
+		return stream_pointers.at(stream)[result.second.first][result.second.second];
+	}
+	return get_free_block_pointer_with_shortest_IO_queue();
+}
+
+Address Block_Manager_Streams::choose_any_address(Event const& write) {
+	Address a = get_free_block_pointer_with_shortest_IO_queue();
+	if (has_free_pages(a)) {
+		return a;
+	}
+	for (auto s : stream_pointers) {
+		for (uint i = 0; i < s.second.size(); i++) {
+			for (uint j = 0; j < s.second[i].size(); j++) {
+				if (has_free_pages(s.second[i][j])) {
+					return s.second[i][j];
+				}
+			}
+		}
+	}
+	return Address();
+}
+
+void Block_Manager_Streams::print() const {
+	printf("open streams: %d   max: %d   evictions: %ld\n", (int)open_streams.size(), MAX_OPEN_STREAMS, num_stream_evictions);
+	for (auto s : stream_pointers) {
+		printf("stream %d\n", s.first);
+		for (auto p : s.second) {
+			for (auto d : p) {
+				printf("\t");
+				d.print();
+				printf("\n");
+			}
+		}
+	}
+}
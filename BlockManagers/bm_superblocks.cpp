@@ -0,0 +1,251 @@
+/*
+ * bm_superblocks.cpp
+ *
+ * A block manager that stripes writes over superblocks, one block per LUN, and garbage-collects whole superblocks.
+ */
+
+#include <new>
+#include <assert.h>
+#include <stdio.h>
+#include <algorithm>
+#include "../ssd.h"
+
+using namespace ssd;
+
+Block_Manager_Superblocks::Block_Manager_Superblocks()
+: Block_manager_parent(),
+  open_pointers(SSD_SIZE, vector<Address>(PACKAGE_SIZE)),
+  full_superblocks(),
+  victim(),
+  superblock_of_lba(NUMBER_OF_ADDRESSABLE_PAGES(), UNDEFINED),
+  next_superblock_id(0), open_superblock_id(UNDEFINED),
+  num_superblocks_opened(0), num_superblocks_collected(0), num_superblock_migrations(0),
+  num_sequential_writes(0), num_sequential_writes_kept_together(0)
+{}
+
+Block_Manager_Superblocks::~Block_Manager_Superblocks() {
+	print();
+}
+
+void Block_Manager_Superblocks::init(Ssd* ssd, FtlParent* ftl, IOScheduler* sched, Garbage_Collector* gc, Wear_Leveling_Strategy* wl, Migrator* migrator) {
+	Block_manager_parent::init(ssd, ftl, sched, gc, wl, migrator);
+	open_superblock(0);
+}
+
+// A LUN without a free block is left out of the superblock, and the stripe goes over the other LUNs
+void Block_Manager_Superblocks::open_superblock(double time) {
+	for (uint i = 0; i < SSD_SIZE; i++) {
+		for (uint j = 0; j < PACKAGE_SIZE; j++) {
+			open_pointers[i][j] = find_free_unused_block(i, j, time);
+		}
+	}
+	if (is_superblock_full()) {
+		open_superblock_id = UNDEFINED;
+		return;
+	}
+	open_superblock_id = next_superblock_id++;
+	num_superblocks_opened++;
+}
+
+bool Block_Manager_Superblocks::is_superblock_full() const {
+	return get_current_superpage() == BLOCK_SIZE;
+}
+
+// The superpage being filled is the lowest page that a block of the open superblock has free
+int Block_Manager_Superblocks::get_current_superpage() const {
+	int superpage = BLOCK_SIZE;
+	for (uint i = 0; i < SSD_SIZE; i++) {
+		for (uint j = 0; j < PACKAGE_SIZE; j++) {
+			if (has_free_pages(open_pointers[i][j])) {
+				superpage = min(superpage, (int) open_pointers[i][j].page);
+			}
+		}
+	}
+	return superpage;
+}
+
+long Block_Manager_Superblocks::get_num_valid_pages(vector<vector<Address> > const& superblock) const {
+	long num_valid_pages = 0;
+	for (auto const& package : superblock) {
+		for (auto const& a : package) {
+			if (a.valid >= BLOCK) {
+				num_valid_pages += ssd->get_package(a.package)->get_die(a.die)->get_plane(a.plane)->get_block(a.block)->get_pages_valid();
+			}
+		}
+	}
+	return num_valid_pages;
+}
+
+// All writes, GC included, wait for a LUN of the current superpage. Only once no superblock can be opened
+// do writes fall back on the per-LUN blocks of the parent, and GC gets a chance to make room.
+Address Block_Manager_Superblocks::choose_write_address(Event& write) {
+	if (write.get_event_type() == COPY_BACK || is_superblock_full()) {
+		return Block_manager_parent::choose_write_address(write);
+	}
+	if (get_num_pages_available_for_new_writes() == 0 && !write.is_garbage_collection_op()) {
+		return Address();
+	}
+	return choose_best_address(write);
+}
+
+// Of the LUNs still missing a page of the current superpage, the one with the shortest queue is chosen
+Address Block_Manager_Superblocks::choose_best_address(Event& write) {
+	int superpage = get_current_superpage();
+	vector<vector<Address> > stripe(SSD_SIZE, vector<Address>(PACKAGE_SIZE));
+	for (uint i = 0; i < SSD_SIZE; i++) {
+		for (uint j = 0; j < PACKAGE_SIZE; j++) {
+			if (has_free_pages(open_pointers[i][j]) && open_pointers[i][j].page == superpage) {
+				stripe[i][j] = open_pointers[i][j];
+			}
+		}
+	}
+	pair<bool, pair<int, int> > result = get_free_block_pointer_with_shortest_IO_queue(stripe);
+	return result.first ? stripe[result.second.first][result.second.second] : Address();
+}
+
+Address Block_Manager_Superblocks::choose_any_address(Event const& write) {
+	return get_free_block_pointer_with_shortest_IO_queue();
+}
+
+void Block_Manager_Superblocks::register_write_outcome(Event const& event, enum status status) {
+	Block_manager_parent::register_write_outcome(event, status);
+	Address ba = event.get_address();
+	Address& pointer = open_pointers[ba.package][ba.die];
+	bool in_open_superblock = pointer.valid == PAGE && ba.compare(pointer) >= BLOCK;
+
+	long lba = event.get_logical_address();
+	if (lba >= 0 && lba < (long)superblock_of_lba.size()) {
+		superblock_of_lba[lba] = in_open_superblock ? open_superblock_id : UNDEFINED;
+		if (!event.is_garbage_collection_op() && lba > 0 && superblock_of_lba[lba - 1] != UNDEFINED) {
+			num_sequential_writes++;
+			if (superblock_of_lba[lba - 1] == superblock_of_lba[lba]) {
+				num_sequential_writes_kept_together++;
+			}
+		}
+	}
+
+	if (!in_open_superblock) {
+		return;
+	}
+	increment_pointer(pointer);
+	if (!is_superblock_full()) {
+		return;
+	}
+	vector<vector<Address> > full_superblock = open_pointers;
+	for (auto& package : full_superblock) {
+		for (auto& a : package) {
+			if (a.valid == PAGE) {
+				a.valid = BLOCK;
+				a.page = 0;
+			}
+		}
+	}
+	full_superblocks.push_back(full_superblock);
+	open_superblock(event.get_current_time());
+	check_if_should_trigger_more_GC(event);
+}
+
+bool Block_Manager_Superblocks::is_empty(vector<vector<Address> > const& superblock) const {
+	for (auto const& package : superblock) {
+		for (auto const& member : package) {
+			if (member.valid != NONE) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool Block_Manager_Superblocks::remove_erased_block(vector<vector<Address> >& superblock, Address const& block) {
+	if (superblock.empty()) {
+		return false;
+	}
+	Address& member = superblock[block.package][block.die];
+	if (member.valid == NONE || member.compare(block) < BLOCK) {
+		return false;
+	}
+	member = Address();
+	return true;
+}
+
+// The erased block may have been taken by the greedy GC from any superblock, so it is looked up in all of them.
+// A full block of the open superblock may be taken too, and is then left out of the stripe.
+void Block_Manager_Superblocks::register_erase_outcome(Event& event, enum status status) {
+	Address a = event.get_address();
+	if (remove_erased_block(victim, a) && is_empty(victim)) {
+		victim.clear();
+		num_superblocks_collected++;
+	}
+	for (deque<vector<vector<Address> > >::iterator it = full_superblocks.begin(); it != full_superblocks.end(); it++) {
+		if (remove_erased_block(*it, a) && is_empty(*it)) {
+			full_superblocks.erase(it);
+			break;
+		}
+	}
+	Address& open = open_pointers[a.package][a.die];
+	if (open.valid == PAGE && !has_free_pages(open) && open.compare(a) >= BLOCK) {
+		open = Address();
+	}
+
+	Block_manager_parent::register_erase_outcome(event, status);
+
+	if (!has_free_pages(free_block_pointers[a.package][a.die])) {
+		free_block_pointers[a.package][a.die] = find_free_unused_block(a.package, a.die, event.get_current_time());
+		if (has_free_pages(free_block_pointers[a.package][a.die])) {
+			Free_Space_Per_LUN_Meter::mark_new_space(a, event.get_current_time());
+		}
+	}
+	if (is_superblock_full()) {
+		open_superblock(event.get_current_time());
+	}
+}
+
+// Once a LUN runs low on free blocks, the full superblock with the fewest live pages becomes the victim,
+// and all of its blocks are garbage-collected before another superblock is chosen
+void Block_Manager_Superblocks::check_if_should_trigger_more_GC(Event const& event) {
+	if (victim.empty() && !full_superblocks.empty()) {
+		bool needs_space = false;
+		for (uint i = 0; i < SSD_SIZE; i++) {
+			for (uint j = 0; j < PACKAGE_SIZE; j++) {
+				needs_space = needs_space || get_num_free_blocks(i, j) < GREED_SCALE;
+			}
+		}
+		if (!needs_space) {
+			return;
+		}
+		deque<vector<vector<Address> > >::iterator best = full_superblocks.begin();
+		long fewest_valid_pages = get_num_valid_pages(*best);
+		for (deque<vector<vector<Address> > >::iterator it = full_superblocks.begin(); it != full_superblocks.end(); it++) {
+			long num_valid_pages = get_num_valid_pages(*it);
+			if (num_valid_pages < fewest_valid_pages) {
+				fewest_valid_pages = num_valid_pages;
+				best = it;
+			}
+		}
+		victim = *best;
+		full_superblocks.erase(best);
+		num_superblock_migrations += fewest_valid_pages;
+	}
+	collect_victim(event.get_current_time());
+}
+
+// A block whose GC the migrator turns down, e.g. because its LUN is busy with another one, is tried again after the next erase
+void Block_Manager_Superblocks::collect_victim(double time) {
+	for (auto const& package : victim) {
+		for (auto const& member : package) {
+			if (member.valid != NONE && !migrator->is_being_garbage_collected(member)) {
+				migrator->schedule_gc(time, member.package, member.die, member.block, UNDEFINED);
+			}
+		}
+	}
+}
+
+void Block_Manager_Superblocks::print() const {
+	printf("superblocks:\n");
+	printf("\tblocks per superblock:\t%d\n", SSD_SIZE * PACKAGE_SIZE);
+	printf("\tsuperblocks opened:\t%ld\n", num_superblocks_opened);
+	printf("\tsuperblocks collected:\t%ld\n", num_superblocks_collected);
+	printf("\tfull superblocks now:\t%ld\n", (long) full_superblocks.size());
+	printf("\tpages migrated per collected superblock:\t%f\n", num_superblocks_collected == 0 ? 0 : num_superblock_migrations / (double) num_superblocks_collected);
+	printf("\twrites whose preceding logical page is in the same superblock:\t%f\n", num_sequential_writes == 0 ? 0 : num_sequential_writes_kept_together / (double) num_sequential_writes);
+}
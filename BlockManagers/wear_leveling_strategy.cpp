@@ -10,33 +10,52 @@
 using namespace ssd;
 using namespace std;
 
+#define WL_CANDIDATES_EXAMINED 32 // the most blocks looked at, youngest first, when choosing a block to wear-level
+#define AGE_SPREAD_ROWS_PRINTED 20
+
 Wear_Leveling_Strategy::Wear_Leveling_Strategy()
-	: ssd(NULL),
-	  migrator(NULL),
+	: age_distribution(),
+	  all_blocks(),
 	  num_erases_up_to_date(0),
+	  ssd(NULL),
 	  average_erase_cycle_time(0),
+	  blocks_being_wl(),
+	  migrator(NULL),
 	  max_age(1),
-	  age_distribution(),
-	  all_blocks(),
-	  random_number_generator(90),
-	  block_data(SSD_SIZE * PACKAGE_SIZE * DIE_SIZE * PLANE_SIZE, Block_data()) {
-
-}
+	  block_data(SSD_SIZE * PACKAGE_SIZE * DIE_SIZE * PLANE_SIZE, Block_data()),
+	  youngest_blocks(),
+	  num_wl_ops(0),
+	  num_wl_page_migrations(0),
+	  last_erase_time(0),
+	  age_spread_over_time()
+{}
 
 Wear_Leveling_Strategy::Wear_Leveling_Strategy(Ssd* ssd, Migrator* migrator)
-	: ssd(ssd),
-	  migrator(migrator),
+	: age_distribution(),
+	  all_blocks(),
 	  num_erases_up_to_date(0),
+	  ssd(ssd),
 	  average_erase_cycle_time(0),
+	  blocks_being_wl(),
+	  migrator(migrator),
 	  max_age(1),
-	  age_distribution(),
-	  all_blocks(),
-	  random_number_generator(90),
-	  block_data(SSD_SIZE * PACKAGE_SIZE * DIE_SIZE * PLANE_SIZE, Block_data())
+	  block_data(SSD_SIZE * PACKAGE_SIZE * DIE_SIZE * PLANE_SIZE, Block_data()),
+	  youngest_blocks(),
+	  num_wl_ops(0),
+	  num_wl_page_migrations(0),
+	  last_erase_time(0),
+	  age_spread_over_time()
 {
 	init();
 }
 
+Wear_Leveling_Strategy::~Wear_Leveling_Strategy() {
+	if (ENABLE_WEAR_LEVELING) {
+		print();
+	}
+}
+
+// All blocks start with the same age, so the blocks in their order already make a heap
 void Wear_Leveling_Strategy::init() {
 	age_distribution[0] = NUMBER_OF_ADDRESSABLE_BLOCKS();
 	for (uint i = 0; i < SSD_SIZE; i++) {
@@ -47,6 +66,8 @@ void Wear_Leveling_Strategy::init() {
 					Plane* plane = die->get_plane(t);
 					for (uint b = 0; b < PLANE_SIZE; b++) {
 						Block* block = plane->get_block(b);
+						block_data[all_blocks.size()].heap_index = youngest_blocks.size();
+						youngest_blocks.push_back(all_blocks.size());
 						all_blocks.push_back(block);
 					}
 				}
@@ -67,10 +88,69 @@ double Wear_Leveling_Strategy::get_normalised_age(uint age) const {
 	return normalized_age;
 }
 
-// TODO, at erase registration, there should be a check for WL queue. If not empty, see if can issue a WL operation. If cannot, issue an emergency GC.
-// if the queue is empty, check if should trigger GC.
+bool Wear_Leveling_Strategy::is_younger(int block_id, int other_block_id) const {
+	Block_data const& a = block_data[block_id];
+	Block_data const& b = block_data[other_block_id];
+	return a.age < b.age || (a.age == b.age && a.last_erase_time < b.last_erase_time);
+}
+
+void Wear_Leveling_Strategy::sift_down(int heap_index) {
+	int size = youngest_blocks.size();
+	while (true) {
+		int youngest = heap_index;
+		int left = 2 * heap_index + 1;
+		int right = left + 1;
+		if (left < size && is_younger(youngest_blocks[left], youngest_blocks[youngest])) {
+			youngest = left;
+		}
+		if (right < size && is_younger(youngest_blocks[right], youngest_blocks[youngest])) {
+			youngest = right;
+		}
+		if (youngest == heap_index) {
+			return;
+		}
+		swap(youngest_blocks[heap_index], youngest_blocks[youngest]);
+		block_data[youngest_blocks[heap_index]].heap_index = heap_index;
+		block_data[youngest_blocks[youngest]].heap_index = youngest;
+		heap_index = youngest;
+	}
+}
+
+// A block holds cold data if it is full of data and has gone unerased for longer than blocks usually do
+bool Wear_Leveling_Strategy::is_cold(int block_id, double time) const {
+	Block* block = all_blocks[block_id];
+	Address a = Address(block->get_physical_address(), BLOCK);
+	return block->get_state() == ACTIVE && !migrator->is_being_garbage_collected(a)
+			&& time - block_data[block_id].last_erase_time > average_erase_cycle_time;
+}
+
+// The heap is explored youngest first, from its root down, until a young enough block with cold data turns up
+Block* Wear_Leveling_Strategy::find_youngest_cold_block(double time) const {
+	auto is_older = [this](int heap_index, int other_heap_index) {
+		return is_younger(youngest_blocks[other_heap_index], youngest_blocks[heap_index]);
+	};
+	priority_queue<int, vector<int>, decltype(is_older)> frontier(is_older);
+	frontier.push(0);
+	for (int i = 0; i < WL_CANDIDATES_EXAMINED && !frontier.empty(); i++) {
+		int heap_index = frontier.top();
+		frontier.pop();
+		int block_id = youngest_blocks[heap_index];
+		if (block_data[block_id].age + WEAR_LEVEL_THRESHOLD >= max_age) {
+			return NULL;
+		}
+		if (is_cold(block_id, time)) {
+			return all_blocks[block_id];
+		}
+		for (uint child = 2 * heap_index + 1; child <= 2 * heap_index + 2 && child < youngest_blocks.size(); child++) {
+			frontier.push(child);
+		}
+	}
+	return NULL;
+}
+
 void Wear_Leveling_Strategy::register_erase_completion(Event const& event) {
 	num_erases_up_to_date++;
+	last_erase_time = event.get_current_time();
 	Address pba = event.get_address();
 	Block* b = ssd->get_package(pba.package)->get_die(pba.die)->get_plane(pba.plane)->get_block(pba.block);
 
@@ -85,75 +165,69 @@ void Wear_Leveling_Strategy::register_erase_completion(Event const& event) {
 
 	double time_since_last_erase = event.get_current_time() - data.last_erase_time;
 	data.last_erase_time = event.get_current_time();
+	sift_down(data.heap_index);
 
 	average_erase_cycle_time = average_erase_cycle_time * 0.8 + 0.2 * time_since_last_erase;
-	int age = data.age - 1;
-	if (age_distribution.count(age - 1) == 1) {
-		age_distribution[age - 1]--;
-		age_distribution[age]--;
-		if (age_distribution[age - 1] == 0) {
-			age_distribution.erase(age - 1);
-		}
+	if (--age_distribution[data.age - 1] == 0) {
+		age_distribution.erase(data.age - 1);
 	}
+	age_distribution[data.age]++;
 
-	if (blocks_being_wl.count(b) > 0) {
-		blocks_being_wl.erase(b);
-		StatisticsGatherer::get_global_instance()->print();
+	if (num_erases_up_to_date % all_blocks.size() == 0) {
+		record_age_spread(event.get_current_time());
 	}
 
-	// looking for gc candidates every single time to update the list. This is CPU expensive, so we want to make it more seldom in the future.
-	if (ENABLE_WEAR_LEVELING /* blocks_to_wl.size() == 0 */ && blocks_being_wl.size() < MAX_ONGOING_WL_OPS && max_age > get_min_age() + WEAR_LEVEL_THRESHOLD) {
-		blocks_to_wl.clear();
-		find_wl_candidates(event.get_current_time());
-		//StateVisualiser::print_block_ages();
-		//StatisticsGatherer::get_instance()->print();
-	}
-
-	if (blocks_to_wl.size() > 0 && blocks_being_wl.size() < MAX_ONGOING_WL_OPS) {
-		int random_index = random_number_generator() % blocks_to_wl.size();
-		set<Block*>::iterator i = blocks_to_wl.begin();
-		advance(i, random_index);
-		Block* target = *i;
-		Address addr = Address(target->get_physical_address(), BLOCK);
-		if (PRINT_LEVEL > 1) {
-			printf("Scheduling WL in "); addr.print(); printf("\n");
+	blocks_being_wl.erase(b);
+
+	// Blocks fall behind in age because the data they hold is never overwritten. Moving it out lets them take hot data.
+	bool is_spread_too_wide = max_age > get_min_age() + WEAR_LEVEL_THRESHOLD;
+	bool is_within_bandwidth = num_wl_ops < WEAR_LEVELING_BANDWIDTH * num_erases_up_to_date;
+	if (ENABLE_WEAR_LEVELING && is_spread_too_wide && is_within_bandwidth && blocks_being_wl.size() < MAX_ONGOING_WL_OPS) {
+		Block* target = find_youngest_cold_block(event.get_current_time());
+		if (target != NULL) {
+			Address addr = Address(target->get_physical_address(), BLOCK);
+			if (PRINT_LEVEL > 1) {
+				printf("Scheduling WL in "); addr.print(); printf("\n");
+			}
+			migrator->schedule_gc(event.get_current_time(), addr.package, addr.die, addr.block, -1, false, true);
 		}
-		migrator->schedule_gc(event.get_current_time(), addr.package, addr.die, addr.block, -1);
 	}
 }
 
+// Called by the migrator once it takes on a wear leveling operation
 bool Wear_Leveling_Strategy::schedule_wear_leveling_op(Block* victim) {
 	if (blocks_being_wl.size() >= MAX_ONGOING_WL_OPS) {
 		return false;
-	} else {
-		blocks_being_wl.insert(victim);
 	}
-	blocks_to_wl.erase(victim);
+	blocks_being_wl.insert(victim);
+	num_wl_ops++;
+	num_wl_page_migrations += victim->get_pages_valid();
+	return true;
 }
 
-/*void Wear_Leveling_Strategy::update_blocks_with_min_age(uint min_age) {
-	for (uint i = 0; i < all_blocks.size(); i++) {
-		Block* b = all_blocks[i];
-		uint age_ith_block = BLOCK_ERASES - b->get_erases_remaining();
-		if (age_ith_block == min_age) {
-			blocks_with_min_age.insert(all_blocks[i]);
-		}
-	}
-}*/
-
-void Wear_Leveling_Strategy::find_wl_candidates(double current_time) {
-	for (uint i = 0; i < all_blocks.size(); i++) {
-		Block* b = all_blocks[i];
-		Block_data& data = block_data[i];
-		double normalised_age = get_normalised_age(data.age);
-		double time_since_last_erase = current_time - data.last_erase_time;
-		if (b->get_state() == ACTIVE && normalised_age < 0.1 && time_since_last_erase  > average_erase_cycle_time * 10) {
-			blocks_to_wl.insert(b);
-		}
+void Wear_Leveling_Strategy::record_age_spread(double time) {
+	age_spread s = { time, (int) get_min_age(), max_age, num_erases_up_to_date / (double) all_blocks.size() };
+	age_spread_over_time.push_back(s);
+}
+
+// The SSD wears out once its oldest block does. At the rate of wear so far, that takes the time so far
+// times the erases a block can take over the age of the oldest block, or over the average age if wear were perfectly even.
+void Wear_Leveling_Strategy::print() const {
+	double average_age = num_erases_up_to_date / (double) all_blocks.size();
+	printf("wear leveling:\n");
+	printf("\tyoungest block age:\t%d\n", (int) get_min_age());
+	printf("\toldest block age:\t%d\n", max_age);
+	printf("\taverage block age:\t%f\n", average_age);
+	printf("\twear leveling operations:\t%ld\n", num_wl_ops);
+	printf("\tlive pages in wear-levelled blocks:\t%ld\n", num_wl_page_migrations);
+	if (num_erases_up_to_date > 0) {
+		printf("\tprojected lifetime (us):\t%f\n", last_erase_time * BLOCK_ERASES / max_age);
+		printf("\tprojected lifetime with even wear (us):\t%f\n", last_erase_time * BLOCK_ERASES / average_age);
 	}
-	if (PRINT_LEVEL > 1) {
-		printf("%d elements inserted into WL queue\n", blocks_to_wl.size());
+	printf("\tage spread over time (time, youngest, oldest, average):\n");
+	uint step = max(1, (int) age_spread_over_time.size() / AGE_SPREAD_ROWS_PRINTED);
+	for (uint i = 0; i < age_spread_over_time.size(); i += step) {
+		age_spread const& s = age_spread_over_time[i];
+		printf("\t\t%f\t%d\t%d\t%f\n", s.time, s.min_age, s.max_age, s.average_age);
 	}
 }
-
-
@@ -7,11 +7,22 @@
 using namespace ssd;
 int DFTL::ENTRIES_PER_TRANSLATION_PAGE = 1024;
 bool DFTL::SEPERATE_MAPPING_PAGES = true;
+int DFTL::WRITE_BACK_CANDIDATES = 8;
+int DFTL::MAPPING_PREFETCH_DEPTH = 256;
+int DFTL::MAX_PREFETCHES_IN_FLIGHT = 4;
+
+#define MAX_READ_STREAMS 8
+#define PREFETCH_CONFIDENCE 2 // the number of reads that must follow a stride before the stream is prefetched
 
 DFTL::DFTL(Ssd *ssd, Block_manager_parent* bm) :
 		flash_resident_page_ftl(ssd, bm),
 		ongoing_mapping_operations(),
 		application_ios_waiting_for_translation(),
+		ongoing_write_backs(),
+		num_entries_being_written_back(0),
+		read_streams(),
+		prefetch_windows(),
+		ongoing_prefetches(),
 		mapping_pages(NUMBER_OF_ADDRESSABLE_PAGES() / ENTRIES_PER_TRANSLATION_PAGE)
 {
 	IS_FTL_PAGE_MAPPING = true;
@@ -20,25 +31,32 @@ DFTL::DFTL(Ssd *ssd, Block_manager_parent* bm) :
 DFTL::DFTL() :
 		flash_resident_page_ftl(),
 		ongoing_mapping_operations(),
-		application_ios_waiting_for_translation()
+		application_ios_waiting_for_translation(),
+		ongoing_write_backs(),
+		num_entries_being_written_back(0),
+		read_streams(),
+		prefetch_windows(),
+		ongoing_prefetches()
 {
 	IS_FTL_PAGE_MAPPING = true;
 }
 
 DFTL::~DFTL(void)
 {
-	delete cache;
 	assert(application_ios_waiting_for_translation.size() == 0);
 	print();
+	delete cache;
 }
 
 
 void DFTL::read(Event *event) {
 
 	long la = event->get_logical_address();
+	dftl_stats.num_app_reads++;
 	// If the logical address is in the cached mapping table, submit the IO
 	if (cache->register_read_arrival(event)) {
 		scheduler->schedule_event(event);
+		register_read_stream(la, event->get_current_time());
 		return;
 	}
 
@@ -54,6 +72,7 @@ void DFTL::read(Event *event) {
 	}
 
 	// If there is no mapping IO currently targeting the translation page, create on. Otherwise, invoke current event when ongoing mapping IO finishes.
+	dftl_stats.num_reads_waiting_for_translation++;
 	if (ongoing_mapping_operations.count(NUMBER_OF_ADDRESSABLE_PAGES() - translation_page_id) == 1) {
 		application_ios_waiting_for_translation[translation_page_id].push_back(event);
 	}
@@ -61,6 +80,105 @@ void DFTL::read(Event *event) {
 		//printf("creating mapping read %d for app write %d\n", translation_page_id, event->get_logical_address());
 		create_mapping_read(translation_page_id, event->get_current_time(), event);
 	}
+	register_read_stream(la, event->get_current_time());
+}
+
+// Matches the read to a stream, and once the stream has followed its stride long enough, reads the translation pages
+// of its next MAPPING_PREFETCH_DEPTH reads. A translation page already being read only gets its prefetch window extended.
+void DFTL::register_read_stream(long lba, double time) {
+	if (MAPPING_PREFETCH_DEPTH == 0) {
+		return;
+	}
+	read_stream* stream = NULL;
+	for (auto& s : read_streams) {
+		if (s.stride != 0 && lba == s.last_lba + s.stride) {
+			stream = &s;
+			stream->confidence++;
+			break;
+		}
+	}
+	for (uint i = 0; stream == NULL && i < read_streams.size(); i++) {
+		long stride = lba - read_streams[i].last_lba;
+		if (stride != 0 && abs(stride) <= ENTRIES_PER_TRANSLATION_PAGE) {
+			stream = &read_streams[i];
+			stream->stride = stride;
+			stream->confidence = 0;
+			stream->prefetched_until = lba;
+		}
+	}
+	if (stream == NULL) {
+		read_stream new_stream = { lba, 0, 0, lba, time };
+		if (read_streams.size() < MAX_READ_STREAMS) {
+			read_streams.push_back(new_stream);
+		} else {
+			auto oldest = read_streams.begin();
+			for (auto it = read_streams.begin(); it != read_streams.end(); it++) {
+				if ((*it).last_access < (*oldest).last_access) {
+					oldest = it;
+				}
+			}
+			*oldest = new_stream;
+		}
+		return;
+	}
+	stream->last_lba = lba;
+	stream->last_access = time;
+	if (stream->confidence < PREFETCH_CONFIDENCE) {
+		return;
+	}
+
+	// The stream's entries are fetched a translation page at a time, since one mapping read brings them all
+	long max_lba = NUMBER_OF_ADDRESSABLE_PAGES() * OVER_PROVISIONING_FACTOR;
+	long next_lba = stream->prefetched_until + stream->stride;
+	if ((next_lba - lba) / stream->stride < 1) {
+		next_lba = lba + stream->stride;
+	}
+	while ((next_lba - lba) / stream->stride <= MAPPING_PREFETCH_DEPTH && next_lba >= 0 && next_lba < max_lba) {
+		long translation_page_id = next_lba / ENTRIES_PER_TRANSLATION_PAGE;
+		long first_key_in_translation_page = translation_page_id * ENTRIES_PER_TRANSLATION_PAGE;
+		long boundary = stream->stride > 0 ? first_key_in_translation_page + ENTRIES_PER_TRANSLATION_PAGE - 1 : first_key_in_translation_page;
+		long num_entries = min((boundary - next_lba) / stream->stride + 1, (long)MAPPING_PREFETCH_DEPTH);
+		long last_lba_in_window = next_lba + (num_entries - 1) * stream->stride;
+
+		bool is_translation_page_read = ongoing_mapping_operations.count(NUMBER_OF_ADDRESSABLE_PAGES() - translation_page_id) == 1;
+		if (!is_translation_page_read && prefetch_windows.count(translation_page_id) == 0) {
+			if (cache->contains(next_lba) || page_mapping->get_physical_address(next_lba).valid == NONE
+					|| page_mapping->get_physical_address(NUMBER_OF_ADDRESSABLE_PAGES() - translation_page_id).valid == NONE) {
+				stream->prefetched_until = next_lba;
+				next_lba += stream->stride;
+				continue;
+			}
+			if (ongoing_prefetches.size() >= MAX_PREFETCHES_IN_FLIGHT) {
+				break;
+			}
+			create_mapping_read(translation_page_id, time, NULL);
+			ongoing_prefetches.insert(translation_page_id);
+			dftl_stats.num_prefetch_reads++;
+		}
+		if (prefetch_windows.count(translation_page_id) == 0 || prefetch_windows[translation_page_id].stride != stream->stride) {
+			prefetch_window window = { next_lba, stream->stride, 0 };
+			prefetch_windows[translation_page_id] = window;
+		}
+		prefetch_window& window = prefetch_windows[translation_page_id];
+		window.num_entries = max(window.num_entries, (int)((last_lba_in_window - window.first_lba) / window.stride) + 1);
+		stream->prefetched_until = last_lba_in_window;
+		next_lba = last_lba_in_window + stream->stride;
+	}
+}
+
+void DFTL::insert_prefetched_entries(long translation_page_id) {
+	ongoing_prefetches.erase(translation_page_id);
+	if (prefetch_windows.count(translation_page_id) == 0) {
+		return;
+	}
+	prefetch_window window = prefetch_windows[translation_page_id];
+	prefetch_windows.erase(translation_page_id);
+	for (int i = 0; i < window.num_entries; i++) {
+		long lba = window.first_lba + i * window.stride;
+		if (lba / ENTRIES_PER_TRANSLATION_PAGE == translation_page_id && !cache->contains(lba) && page_mapping->get_physical_address(lba).valid == PAGE) {
+			cache->register_prefetch(lba);
+		}
+	}
 }
 
 void DFTL::register_read_completion(Event const& event, enum status result) {
@@ -99,6 +217,8 @@ void DFTL::register_read_completion(Event const& event, enum status result) {
 		}
 		scheduler->schedule_event(e);
 	}
+	insert_prefetched_entries(translation_page_id);
+	register_translation_page_read(translation_page_id);
 
 	try_clear_space_in_mapping_cache(event.get_current_time());
 }
@@ -107,17 +227,19 @@ void DFTL::notify_garbage_collector(int translation_page_id, double time) {
 	if (gc == NULL) {
 		return;
 	}
+	vector<int> const& physical_pages = mapping_pages[translation_page_id].physical_pages;
 	long first_key_in_translation_page = translation_page_id * ENTRIES_PER_TRANSLATION_PAGE;
 	for (int i = first_key_in_translation_page;
 			i < first_key_in_translation_page + ENTRIES_PER_TRANSLATION_PAGE; ++i) {
-		if (cache->contains(i) && cache->cached_mapping_table[i].synch_flag == false) {
-			Address old_address = mapping_pages[translation_page_id].entries[i];
-			if (old_address.valid == PAGE) {
+		if (cache->contains(i) && !cache->is_synchronized(i)) {
+			int old_physical_page = physical_pages.empty() ? UNDEFINED : physical_pages[i - first_key_in_translation_page];
+			if (old_physical_page != UNDEFINED) {
+				Address old_address = Address(old_physical_page, PAGE);
 				Address current_address = page_mapping->get_physical_address(i);
 				assert(old_address.compare(current_address) != PAGE);
 				gc->invalid_address_notification(old_address, time);
 			}
-			cache->cached_mapping_table[i].synch_flag = true;
+			cache->set_synchronized(i);
 		}
 	}
 
@@ -165,6 +287,10 @@ void DFTL::register_write_completion(Event const& event, enum status result) {
 	if (event.get_noop()) {
 		return;
 	}
+	// Writes of translation pages update the global translation directory, which is journaled too
+	if (map_persistence != NULL) {
+		map_persistence->register_mapping_update(event.get_logical_address(), event.get_current_time());
+	}
 	if (!event.is_mapping_op()) {
 		cache->register_write_completion(event);
 		try_clear_space_in_mapping_cache(event.get_current_time());
@@ -179,14 +305,17 @@ void DFTL::register_write_completion(Event const& event, enum status result) {
 
 	// mark all pages included as clean
 	mark_clean(translation_page_id, event);
+	num_entries_being_written_back -= ongoing_write_backs[translation_page_id];
+	ongoing_write_backs.erase(translation_page_id);
 
-	mapping_pages[translation_page_id].entries.clear();
+	vector<int>& physical_pages = mapping_pages[translation_page_id].physical_pages;
+	physical_pages.resize(ENTRIES_PER_TRANSLATION_PAGE);
 	long first_key_in_translation_page = translation_page_id * ENTRIES_PER_TRANSLATION_PAGE;
-	for (int i = first_key_in_translation_page;
-			i < first_key_in_translation_page + ENTRIES_PER_TRANSLATION_PAGE; ++i) {
-		Address a = page_mapping->get_physical_address(i);
-		mapping_pages[translation_page_id].entries[i] = a;
+	for (int i = 0; i < ENTRIES_PER_TRANSLATION_PAGE; ++i) {
+		Address a = page_mapping->get_physical_address(first_key_in_translation_page + i);
+		physical_pages[i] = a.valid == PAGE ? a.get_linear_address() : UNDEFINED;
 	}
+	register_translation_page_write(translation_page_id);
 
 
 	// schedule all operations
@@ -197,6 +326,7 @@ void DFTL::register_write_completion(Event const& event, enum status result) {
 		cache->handle_read_dependency(e);
 		scheduler->schedule_event(e);
 	}
+	insert_prefetched_entries(translation_page_id);
 	//try_clear_space_in_mapping_cache(event.get_current_time());
 }
 
@@ -210,6 +340,12 @@ void DFTL::register_trim_completion(Event & event) {
 	page_mapping->register_trim_completion(event);
 }
 
+// A checkpoint holds the global translation directory and the dirty entries of the cache,
+// as the translation pages on flash hold the rest of the map
+long DFTL::get_num_entries_to_checkpoint() const {
+	return mapping_pages.size() + cache->get_num_dirty_entries();
+}
+
 long DFTL::get_logical_address(uint physical_address) const {
 	return page_mapping->get_logical_address(physical_address);
 }
@@ -279,8 +415,8 @@ void DFTL::mark_clean(long translation_page_id, Event const& event) {
 
 	StatisticData::register_statistic("dftl_cache_size", {
 			new Integer(StatisticsGatherer::get_global_instance()->total_writes()),
-			new Integer(cache->cached_mapping_table.size()),
-			new Integer(ftl_cache::CACHED_ENTRIES_THRESHOLD)
+			new Integer(cache->size()),
+			new Integer(cache->get_capacity())
 	});
 
 	StatisticData::register_field_names("", {
@@ -300,24 +436,17 @@ void DFTL::mark_clean(long translation_page_id, Event const& event) {
 void DFTL::try_clear_space_in_mapping_cache(double time) {
 	//while (cache.cached_mapping_table.size() >= CACHED_ENTRIES_THRESHOLD && flush_mapping(time, false));
 	cache->clear_clean_entries(time);
-	if (cache->cached_mapping_table.size() <= ftl_cache::CACHED_ENTRIES_THRESHOLD) {
+	// Dirty entries whose translation page is already being written back will be cleaned along with it
+	if (cache->size() - num_entries_being_written_back <= cache->get_capacity()) {
 		return;
 	}
 	//flush_mapping(time, true);
-	long victim = cache->choose_dirty_victim(time);
-
-	if (victim == UNDEFINED) {
+	long translation_page_id = choose_victim_translation_page(time);
+	if (translation_page_id == UNDEFINED) {
 		return;
 	}
-
-	//ftl_cache::entry victim_entry = cache.cached_mapping_table.at(victim);
-	//victim_entry.hotness = SHRT_MAX;
-
-	long translation_page_id = victim / ENTRIES_PER_TRANSLATION_PAGE;
-		if (ongoing_mapping_operations.count(NUMBER_OF_ADDRESSABLE_PAGES() - translation_page_id) == 1) {
-			cache->eviction_queue_dirty.push(victim);
-			return;
-		}
+	ongoing_write_backs[translation_page_id] = cache->get_num_dirty_entries(translation_page_id);
+	num_entries_being_written_back += ongoing_write_backs[translation_page_id];
 
 		// create mapping write
 		Event* mapping_event = new Event(WRITE, NUMBER_OF_ADDRESSABLE_PAGES() - translation_page_id, 1, time);
@@ -360,6 +489,46 @@ void DFTL::try_clear_space_in_mapping_cache(double time) {
 		}
 }
 
+// The clock policy proposes a few cold dirty entries, and the translation page with the most dirty entries among
+// theirs is written back, since one mapping write cleans all of them. Dirty victims stay on the dirty list,
+// so a translation page with an ongoing mapping operation is passed over and proposed again later.
+long DFTL::choose_victim_translation_page(double time) {
+	long best_translation_page_id = UNDEFINED;
+	for (int i = 0; i < WRITE_BACK_CANDIDATES; i++) {
+		long victim = cache->choose_dirty_victim(time);
+		if (victim == UNDEFINED) {
+			break;
+		}
+		long translation_page_id = victim / ENTRIES_PER_TRANSLATION_PAGE;
+		if (ongoing_mapping_operations.count(NUMBER_OF_ADDRESSABLE_PAGES() - translation_page_id) == 1) {
+			continue;
+		}
+		if (best_translation_page_id == UNDEFINED || cache->get_num_dirty_entries(translation_page_id) > cache->get_num_dirty_entries(best_translation_page_id)) {
+			best_translation_page_id = translation_page_id;
+		}
+	}
+	return best_translation_page_id;
+}
+
+// Physical pages are numbered across LUNs first, the way the block manager stripes consecutive writes,
+// so that the pages of a sequential write get consecutive numbers
+long DFTL::get_striped_page_number(int physical_page) {
+	Address a = Address(physical_page, PAGE);
+	long lun = a.package * PACKAGE_SIZE + a.die;
+	long offset_in_lun = ((long) a.plane * PLANE_SIZE + a.block) * BLOCK_SIZE + a.page;
+	return offset_in_lun * SSD_SIZE * PACKAGE_SIZE + lun;
+}
+
+// The RAM of the mapping cache, which fits CACHED_ENTRIES_THRESHOLD page-level entries, is shared between
+// dirty entries, which are always stored as page-level entries, and clean entries, which a subclass may store more compactly
+void DFTL::set_cache_ram_per_clean_entry(double bytes) {
+	double budget = ftl_cache::CACHED_ENTRIES_THRESHOLD * (double) MAPPING_ENTRY_SIZE;
+	bytes = min(bytes, (double) MAPPING_ENTRY_SIZE);
+	int num_dirty = min(cache->get_num_dirty_entries(), ftl_cache::CACHED_ENTRIES_THRESHOLD);
+	double budget_left = budget - num_dirty * MAPPING_ENTRY_SIZE;
+	cache->set_capacity(num_dirty + budget_left / bytes);
+}
+
 void DFTL::create_mapping_read(long translation_page_id, double time, Event* dependant) {
 	Event* mapping_event = new Event(READ, NUMBER_OF_ADDRESSABLE_PAGES() - translation_page_id, 1, time);
 	if (mapping_event->get_logical_address() == 1048259) {
@@ -370,7 +539,9 @@ void DFTL::create_mapping_read(long translation_page_id, double time, Event* dep
 	Address physical_addr_of_translation_page = page_mapping->get_physical_address(mapping_event->get_logical_address());
 	mapping_event->set_address(physical_addr_of_translation_page);
 	application_ios_waiting_for_translation[translation_page_id] = vector<Event*>();
-	application_ios_waiting_for_translation[translation_page_id].push_back(dependant);
+	if (dependant != NULL) {
+		application_ios_waiting_for_translation[translation_page_id].push_back(dependant);
+	}
 	assert(ongoing_mapping_operations.count(mapping_event->get_logical_address()) == 0);
 	ongoing_mapping_operations.insert(mapping_event->get_logical_address());
 	scheduler->schedule_event(mapping_event);
@@ -383,17 +554,18 @@ void DFTL::print_short() const {
 	int num_cold = 0;
 	int num_hot = 0;
 	int num_super_hot = 0;
-	for (auto i : cache->cached_mapping_table) {
-		if (i.second.dirty) num_dirty++;
-		if (!i.second.dirty) num_clean++;
-		if (i.second.fixed) num_fixed++;
-		if (i.second.hotness == 0) num_cold++;
-		if (i.second.hotness == 1) num_hot++;
-		if (i.second.hotness > 1) num_super_hot++;
-	}
-	printf("total: %d\tdirty: %d\tclean: %d\tfixed: %d\tcold: %d\thot: %d\tvery hot: %d\tnum ios: %d\n", cache->cached_mapping_table.size(), num_dirty, num_clean, num_fixed, num_cold, num_hot, num_super_hot, StatisticsGatherer::get_global_instance()->total_writes());
-	printf("clean queue: %d \t dirty queue %d \n", cache->eviction_queue_clean.size(), cache->eviction_queue_dirty.size());
-	printf("threshold: %d\t cache: %d\n", ftl_cache::CACHED_ENTRIES_THRESHOLD, cache->cached_mapping_table.size());
+	for (auto e : cache->slots) {
+		if (e.key == UNDEFINED) continue;
+		if (e.dirty) num_dirty++;
+		if (!e.dirty) num_clean++;
+		if (e.fixed) num_fixed++;
+		if (e.hotness == 0) num_cold++;
+		if (e.hotness == 1) num_hot++;
+		if (e.hotness > 1) num_super_hot++;
+	}
+	printf("total: %d\tdirty: %d\tclean: %d\tfixed: %d\tcold: %d\thot: %d\tvery hot: %d\tnum ios: %d\n", cache->size(), num_dirty, num_clean, num_fixed, num_cold, num_hot, num_super_hot, StatisticsGatherer::get_global_instance()->total_writes());
+	printf("clean list: %d \t dirty list %d \n", cache->get_num_clean_entries(), cache->get_num_dirty_entries());
+	printf("threshold: %d\t cache: %d\n", cache->get_capacity(), cache->size());
 }
 
 // used for debugging
@@ -412,9 +584,10 @@ void DFTL::print() const {
 
 	// cluster by mapping page
 	map<int, int> bins;
-	for (auto i : cache->cached_mapping_table) {
-		//long translation_page_id = la / ENTRIES_PER_TRANSLATION_PAGE;
-		bins[i.first / ENTRIES_PER_TRANSLATION_PAGE]++;
+	for (auto e : cache->slots) {
+		if (e.key != UNDEFINED) {
+			bins[e.key / ENTRIES_PER_TRANSLATION_PAGE]++;
+		}
 	}
 
 	printf("histogram1:");
@@ -447,4 +620,16 @@ void DFTL::print() const {
 	for (auto i : dftl_stats.address_hits) {
 		printf("%d  %d\n", i.first, i.second);
 	}*/
+
+	printf("mapping cache:\n");
+	printf("\tcapacity (entries):\t%d\n", cache->get_capacity());
+	printf("\tmapping miss rate:\t%f\n", dftl_stats.num_app_reads == 0 ? 0 : dftl_stats.num_reads_waiting_for_translation / (double) dftl_stats.num_app_reads);
+	printf("mapping prefetcher:\n");
+	printf("\tapp reads:\t%ld\n", dftl_stats.num_app_reads);
+	printf("\treads waiting for translation:\t%ld\n", dftl_stats.num_reads_waiting_for_translation);
+	printf("\tprefetch reads:\t%ld\n", dftl_stats.num_prefetch_reads);
+	printf("\tprefetched entries:\t%ld\n", cache->num_prefetched_entries);
+	printf("\tprefetched entries read:\t%ld\n", cache->num_prefetch_hits);
+	printf("\tprefetched entries evicted unread:\t%ld\n", cache->num_unused_prefetches);
+	printf("\tprefetch accuracy:\t%f\n", cache->num_prefetched_entries == 0 ? 0 : cache->num_prefetch_hits / (double) cache->num_prefetched_entries);
 }
@@ -348,6 +348,7 @@ void FAST::register_write_completion(Event const& event, enum status result) {
 		}
 
 		if (in_order) {
+			migrator->register_merge(SWITCH_MERGE, 0);
 			translation_table[block_id] = log_block_addr;
 			num_active_log_blocks--;
 			delete lb;
@@ -434,6 +435,7 @@ void FAST::garbage_collect(int block_id, log_block* log_block, double time) {
 		gc_queue[block_id].push(write);
 	}
 
+	migrator->register_merge(FULL_MERGE, BLOCK_SIZE);
 	Address& old_addr = translation_table[block_id];
 	migrator->update_structures(old_addr, time);
 	bm->subtract_from_available_for_new_writes(BLOCK_SIZE);
@@ -475,8 +477,17 @@ void FAST::set_read_address(Event& event) const {
 	event.set_address(cur_block_addr);
 }
 
-// used for debugging
+// RAM holds a block map entry per logical block, and the logical page of each page in the log blocks
 void FAST::print() const {
+	long num_logical_blocks = NUMBER_OF_ADDRESSABLE_BLOCKS() * OVER_PROVISIONING_FACTOR;
+	long block_map_ram = num_logical_blocks * sizeof(int);
+	long log_map_ram = max(NUM_LOG_BLOCKS, 0) * BLOCK_SIZE * sizeof(int);
+	printf("FAST:\n");
+	printf("\tlog blocks:\t%d\n", NUM_LOG_BLOCKS);
+	printf("\tblock map RAM (bytes):\t%ld\n", block_map_ram);
+	printf("\tlog block map RAM (bytes):\t%ld\n", log_map_ram);
+	printf("\tmapping RAM (bytes):\t%ld\n", block_map_ram + log_map_ram);
+	// used for debugging
 	for (auto locked_block : queued_events) {
 		printf("block: %d\n", locked_block.first);
 		queue<Event*>& q = locked_block.second;
@@ -0,0 +1,182 @@
+/*
+ * bast.cpp
+ *
+ * BAST, a block-mapped FTL where each logical block may have a log block of its own.
+ */
+
+#include <new>
+#include <assert.h>
+#include <stdio.h>
+#include <math.h>
+#include "../ssd.h"
+
+using namespace ssd;
+
+#define BLOCK_ADDRESS_SIZE 4 // bytes taken by a block number in RAM
+
+BAST::BAST(Ssd *ssd, Block_manager_parent* bm, Migrator* migrator) :
+		Hybrid_FTL(ssd, bm, migrator, 1),
+		logical_blocks(get_num_groups()),
+		log_block_lru(),
+		NUM_LOG_BLOCKS(NUMBER_OF_ADDRESSABLE_BLOCKS() * (1 - OVER_PROVISIONING_FACTOR) - NUM_RESERVED_BLOCKS - SSD_SIZE * PACKAGE_SIZE),
+		num_log_blocks(0)
+{
+	assert(NUM_LOG_BLOCKS > 0);
+}
+
+BAST::~BAST() {
+	print();
+}
+
+bool BAST::choose_write_address(int group_id, Event* write) {
+	logical_block& lb = logical_blocks[group_id];
+	int offset = write->get_logical_address() % BLOCK_SIZE;
+	double time = write->get_current_time();
+
+	if (lb.data_block.valid == NONE) {
+		lb.data_block = allocate_block(UNDEFINED, false, time);
+		if (lb.data_block.valid == NONE) {
+			choose_log_block_victim(time);
+			wait_for_space(group_id);
+			return false;
+		}
+	}
+
+	// A page can be written in place if no later page of the logical block was written in the data block yet
+	if (offset > lb.last_offset_in_data_block && lb.data_block.page < BLOCK_SIZE) {
+		if (!take_page(lb.data_block, write)) {
+			return false;
+		}
+		lb.last_offset_in_data_block = offset;
+		return true;
+	}
+
+	if (lb.log_block.valid == NONE) {
+		if (num_log_blocks < NUM_LOG_BLOCKS) {
+			lb.log_block = allocate_block(UNDEFINED, false, time);
+		}
+		if (lb.log_block.valid == NONE) {
+			choose_log_block_victim(time);
+			wait_for_space(group_id);
+			return false;
+		}
+		num_log_blocks++;
+		log_block_lru.push_back(group_id);
+	}
+	else if (lb.log_block.page == BLOCK_SIZE) {
+		request_merge(group_id, time);
+		return false;
+	}
+
+	if (!take_page(lb.log_block, write)) {
+		return false;
+	}
+	lb.log_offsets.push_back(offset);
+	log_block_lru.remove(group_id);
+	log_block_lru.push_back(group_id);
+	return true;
+}
+
+// A full log block is merged right away, so that a switch merge does not wait to be picked as a victim
+bool BAST::is_merge_due(int group_id) const {
+	Address const& log_block = logical_blocks[group_id].log_block;
+	return log_block.valid != NONE && log_block.page == BLOCK_SIZE;
+}
+
+// Merges the least recently written log block that is not being merged already
+bool BAST::choose_log_block_victim(double time) {
+	if (!may_request_more_merges()) {
+		return false;
+	}
+	for (auto group_id : log_block_lru) {
+		if (!is_merging(group_id)) {
+			request_merge(group_id, time);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool BAST::is_log_block_in_order(logical_block const& lb) const {
+	for (uint i = 0; i < lb.log_offsets.size(); i++) {
+		if (lb.log_offsets[i] != i) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool BAST::merge(int group_id, double time) {
+	logical_block& lb = logical_blocks[group_id];
+	assert(lb.log_block.valid != NONE);
+	long first_logical_address = group_id * BLOCK_SIZE;
+	vector<long> copies;
+
+	if (is_log_block_in_order(lb) && lb.log_offsets.size() == BLOCK_SIZE) {
+		if (lb.data_block.valid != NONE) {
+			retire_block(lb.data_block, time);
+		}
+		lb.merge = SWITCH_MERGE;
+		lb.last_offset_in_data_block = BLOCK_SIZE - 1;
+		copy_pages(group_id, copies, lb.log_block, time);
+	}
+	// The log block holds the first pages of the logical block in order. The pages after them are in the data block.
+	else if (is_log_block_in_order(lb)) {
+		lb.last_offset_in_data_block = lb.log_offsets.size() - 1;
+		for (int offset = lb.log_offsets.size(); offset < BLOCK_SIZE; offset++) {
+			if (is_mapped(first_logical_address + offset)) {
+				copies.push_back(first_logical_address + offset);
+				lb.last_offset_in_data_block = offset;
+			}
+		}
+		if (lb.data_block.valid != NONE) {
+			retire_block(lb.data_block, time);
+		}
+		lb.merge = PARTIAL_MERGE;
+		copy_pages(group_id, copies, lb.log_block, time);
+	}
+	else {
+		Address destination = allocate_block(UNDEFINED, true, time);
+		if (destination.valid == NONE) {
+			return false;
+		}
+		lb.last_offset_in_data_block = UNDEFINED;
+		for (int offset = 0; offset < BLOCK_SIZE; offset++) {
+			if (is_mapped(first_logical_address + offset)) {
+				copies.push_back(first_logical_address + offset);
+				lb.last_offset_in_data_block = offset;
+			}
+		}
+		if (lb.data_block.valid != NONE) {
+			retire_block(lb.data_block, time);
+		}
+		retire_block(lb.log_block, time);
+		lb.merge = FULL_MERGE;
+		copy_pages(group_id, copies, destination, time);
+	}
+	migrator->register_merge(lb.merge, copies.size());
+	return true;
+}
+
+void BAST::register_merge_completion(int group_id, Address const& destination, double time) {
+	logical_block& lb = logical_blocks[group_id];
+	lb.data_block = destination;
+	lb.log_block = Address();
+	lb.log_offsets.clear();
+	num_log_blocks--;
+	log_block_lru.remove(group_id);
+}
+
+// RAM holds a block map entry per logical block, and for each log block, its logical block and the offset of each of its pages
+void BAST::print() const {
+	long num_logical_blocks = NUMBER_OF_ADDRESSABLE_BLOCKS() * OVER_PROVISIONING_FACTOR;
+	int offset_size = ceil(log2(BLOCK_SIZE) / 8);
+	long block_map_ram = num_logical_blocks * BLOCK_ADDRESS_SIZE;
+	long log_map_ram = NUM_LOG_BLOCKS * (2 * BLOCK_ADDRESS_SIZE + BLOCK_SIZE * offset_size);
+	printf("BAST:\n");
+	printf("\tlog blocks:\t%d\n", NUM_LOG_BLOCKS);
+	printf("\tblock map RAM (bytes):\t%ld\n", block_map_ram);
+	printf("\tlog block map RAM (bytes):\t%ld\n", log_map_ram);
+	printf("\tmapping RAM (bytes):\t%ld\n", block_map_ram + log_map_ram);
+	print_merge_cost();
+}
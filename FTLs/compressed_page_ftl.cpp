@@ -0,0 +1,242 @@
+/*
+ * compressed_page_ftl.cpp
+ *
+ * A page FTL that compresses writes and packs several compressed logical pages into one flash page.
+ */
+
+#include <new>
+#include <assert.h>
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include "../ssd.h"
+
+using namespace ssd;
+
+MTRand_open FtlImpl_Compressed_Page::random_number_generator(8813);
+
+FtlImpl_Compressed_Page::FtlImpl_Compressed_Page(Ssd *ssd, Block_manager_parent* bm):
+	FtlImpl_Page(ssd, bm),
+	pack_of_lba(NUMBER_OF_ADDRESSABLE_PAGES() + 1, UNDEFINED),
+	size_of_lba(NUMBER_OF_ADDRESSABLE_PAGES() + 1, 0),
+	packs(),
+	released_pack_ids(),
+	next_pack_id(0),
+	open_pack(UNDEFINED),
+	repack_reads(),
+	num_mapped_lbas(0),
+	num_app_writes(0), num_buffered_writes(0), num_uncompressed_writes(0), num_pack_flushes(0), num_internal_flushes(0),
+	num_buffered_reads(0), num_decompressed_reads(0), num_repacks(0), num_repacked_pages(0),
+	logical_bytes_written(0), compressed_bytes_written(0), packed_bytes_flushed(0)
+{
+	assert(DEDUPLICATION_MODE == 0);
+	open_pack = allocate_pack();
+}
+
+FtlImpl_Compressed_Page::~FtlImpl_Compressed_Page() {
+	print();
+}
+
+void FtlImpl_Compressed_Page::read(Event *event) {
+	long lba = event->get_logical_address();
+	long pack_id = pack_of_lba[lba];
+	if (pack_id == UNDEFINED) {
+		fprintf(stderr, "You are trying to read logical address %d, but this address has not been written so far.\n", event->get_logical_address());
+		assert(false);
+	}
+	event->set_host_logical_address(lba);
+	event->set_logical_address(pack_id);
+	if (pack_id == open_pack) {
+		event->set_noop(true);
+		num_buffered_reads++;
+	} else if (packs.at(pack_id).compressed) {
+		num_decompressed_reads++;
+	}
+	scheduler->schedule_event(event);
+}
+
+// A write that fits in the open pack is acknowledged once it is buffered. A write that does not fit
+// carries the open pack to flash, and its own data starts the next pack.
+void FtlImpl_Compressed_Page::write(Event *event) {
+	long lba = event->get_logical_address();
+	double time = event->get_current_time();
+	int size = get_compressed_size(*event);
+	event->set_host_logical_address(lba);
+	num_app_writes++;
+	logical_bytes_written += PAGE_SIZE;
+	compressed_bytes_written += size;
+
+	if (pack_of_lba[lba] == UNDEFINED) {
+		num_mapped_lbas++;
+	} else {
+		remove_from_pack(lba, time);
+	}
+	size_of_lba[lba] = size;
+
+	if (size >= PAGE_SIZE) {
+		long pack_id = allocate_pack();
+		pack& p = packs.at(pack_id);
+		p.lbas.push_back(lba);
+		p.live_bytes = size;
+		p.compressed = false;
+		pack_of_lba[lba] = pack_id;
+		event->set_logical_address(pack_id);
+		num_uncompressed_writes++;
+	}
+	else if (packs.at(open_pack).live_bytes + size > PAGE_SIZE) {
+		event->set_logical_address(open_pack);
+		packed_bytes_flushed += packs.at(open_pack).live_bytes;
+		num_pack_flushes++;
+		open_pack = allocate_pack();
+		add_to_open_pack(lba, size);
+	}
+	else {
+		add_to_open_pack(lba, size);
+		event->set_noop(true);
+		num_buffered_writes++;
+	}
+	scheduler->schedule_event(event);
+}
+
+void FtlImpl_Compressed_Page::trim(Event *event) {
+	long lba = event->get_logical_address();
+	event->set_host_logical_address(lba);
+	if (pack_of_lba[lba] != UNDEFINED) {
+		remove_from_pack(lba, event->get_current_time());
+		num_mapped_lbas--;
+	}
+	event->set_noop(true);
+	scheduler->schedule_event(event);
+}
+
+// When a repack read is done, the live logical pages of the pack are in RAM and join the open pack
+void FtlImpl_Compressed_Page::register_read_completion(Event const& event, enum status result) {
+	FtlImpl_Page::register_read_completion(event, result);
+	if (repack_reads.count(event.get_application_io_id()) == 0) {
+		return;
+	}
+	long pack_id = repack_reads.at(event.get_application_io_id());
+	repack_reads.erase(event.get_application_io_id());
+	vector<long> lbas = packs.at(pack_id).lbas;
+	for (auto lba : lbas) {
+		if (packs.at(open_pack).live_bytes + size_of_lba[lba] > PAGE_SIZE) {
+			flush_open_pack(event.get_current_time());
+		}
+		add_to_open_pack(lba, size_of_lba[lba]);
+		num_repacked_pages++;
+	}
+	release_pack(pack_id);
+}
+
+// A pack still being written has no page yet. The read waits for that write in the scheduler,
+// and its address is looked up again once the write is done.
+// The decompression delay is added once, before the read transfer leaves the controller.
+void FtlImpl_Compressed_Page::set_read_address(Event& event) const {
+	long pack_id = event.get_logical_address();
+	Address target = get_physical_address(pack_id);
+	if (target.valid == NONE) {
+		return;
+	}
+	event.set_address(target);
+	bool is_compressed = packs.count(pack_id) == 1 && packs.at(pack_id).compressed;
+	if (is_compressed && event.get_event_type() == READ_TRANSFER && !event.is_garbage_collection_op() && event.get_execution_time() == 0) {
+		event.incr_execution_time(DECOMPRESSION_DELAY);
+	}
+}
+
+int FtlImpl_Compressed_Page::get_compressed_size(Event const& write) {
+	double ratio = write.get_compression_ratio();
+	if (ratio == UNDEFINED) {
+		ratio = COMPRESSION_RATIO_MIN + (COMPRESSION_RATIO_MAX - COMPRESSION_RATIO_MIN) * random_number_generator();
+	}
+	int size = ceil(ratio * PAGE_SIZE);
+	return max(1, min(size, (int)PAGE_SIZE));
+}
+
+// Released pack IDs are reused first, so that the write of the new pack replaces the stale page of the old one
+long FtlImpl_Compressed_Page::allocate_pack() {
+	long pack_id;
+	if (!released_pack_ids.empty()) {
+		pack_id = released_pack_ids.back();
+		released_pack_ids.pop_back();
+	} else {
+		pack_id = next_pack_id++;
+		assert(pack_id <= NUMBER_OF_ADDRESSABLE_PAGES());
+	}
+	packs[pack_id] = pack();
+	return pack_id;
+}
+
+void FtlImpl_Compressed_Page::release_pack(long pack_id) {
+	assert(pack_id != open_pack);
+	packs.erase(pack_id);
+	released_pack_ids.push_back(pack_id);
+}
+
+void FtlImpl_Compressed_Page::add_to_open_pack(long lba, int size) {
+	pack& p = packs.at(open_pack);
+	p.lbas.push_back(lba);
+	p.live_bytes += size;
+	pack_of_lba[lba] = open_pack;
+}
+
+// The logical page leaves dead space behind in its pack. An empty pack is released,
+// and a pack that is mostly dead is repacked.
+void FtlImpl_Compressed_Page::remove_from_pack(long lba, double time) {
+	long pack_id = pack_of_lba[lba];
+	pack& p = packs.at(pack_id);
+	p.lbas.erase(find(p.lbas.begin(), p.lbas.end(), lba));
+	p.live_bytes -= size_of_lba[lba];
+	pack_of_lba[lba] = UNDEFINED;
+	if (pack_id == open_pack || p.being_repacked) {
+		return;
+	}
+	if (p.lbas.empty()) {
+		release_pack(pack_id);
+	} else if (p.compressed && p.live_bytes < COMPRESSION_REPACK_THRESHOLD * PAGE_SIZE) {
+		repack(pack_id, time);
+	}
+}
+
+void FtlImpl_Compressed_Page::flush_open_pack(double time) {
+	Event* write = new Event(WRITE, open_pack, 1, time);
+	packed_bytes_flushed += packs.at(open_pack).live_bytes;
+	num_pack_flushes++;
+	num_internal_flushes++;
+	open_pack = allocate_pack();
+	scheduler->schedule_event(write);
+}
+
+void FtlImpl_Compressed_Page::repack(long pack_id, double time) {
+	packs.at(pack_id).being_repacked = true;
+	Event* read = new Event(READ, pack_id, 1, time);
+	repack_reads[read->get_application_io_id()] = pack_id;
+	num_repacks++;
+	scheduler->schedule_event(read);
+}
+
+// Every pack that is not released holds a valid flash page, so the spare pages left to the garbage collector
+// are those not taken by packs. Released packs keep their stale page valid until their ID is reused.
+void FtlImpl_Compressed_Page::print() const {
+	double num_physical_pages = NUMBER_OF_ADDRESSABLE_PAGES();
+	long num_flash_writes = num_pack_flushes + num_uncompressed_writes;
+	long num_packs_on_flash = packs.size() - 1 + released_pack_ids.size();
+	printf("compressed page FTL:\n");
+	printf("\tapp writes:\t%ld\n", num_app_writes);
+	printf("\tbuffered writes:\t%ld\n", num_buffered_writes);
+	printf("\tuncompressed writes:\t%ld\n", num_uncompressed_writes);
+	printf("\tpack flushes:\t%ld\n", num_pack_flushes);
+	printf("\tinternal pack flushes:\t%ld\n", num_internal_flushes);
+	printf("\tflash writes per app write:\t%f\n", num_app_writes == 0 ? 0 : num_flash_writes / (double) num_app_writes);
+	printf("\tcompression ratio:\t%f\n", logical_bytes_written == 0 ? 0 : compressed_bytes_written / logical_bytes_written);
+	printf("\taverage pack fill:\t%f\n", num_pack_flushes == 0 ? 0 : packed_bytes_flushed / (num_pack_flushes * (double) PAGE_SIZE));
+	printf("\tbuffered reads:\t%ld\n", num_buffered_reads);
+	printf("\tdecompressed reads:\t%ld\n", num_decompressed_reads);
+	printf("\trepacks:\t%ld\n", num_repacks);
+	printf("\trepacked pages:\t%ld\n", num_repacked_pages);
+	printf("\tmapped addresses:\t%ld\n", num_mapped_lbas);
+	printf("\tpacks on flash:\t%ld\n", num_packs_on_flash);
+	printf("\treleased packs awaiting reuse:\t%ld\n", (long) released_pack_ids.size());
+	printf("\tnominal over-provisioning:\t%f\n", 1 - num_mapped_lbas / num_physical_pages);
+	printf("\teffective over-provisioning:\t%f\n", 1 - num_packs_on_flash / num_physical_pages);
+}
@@ -0,0 +1,171 @@
+/*
+ * dedup_index.cpp
+ *
+ * The fingerprint index used by the page FTL for inline deduplication.
+ */
+
+#include <new>
+#include <assert.h>
+#include <stdio.h>
+#include "../ssd.h"
+
+using namespace ssd;
+
+MTRand_open Deduplication_Index::random_number_generator(2398461);
+
+Deduplication_Index::Deduplication_Index()
+	: content_of_lba(NUMBER_OF_ADDRESSABLE_PAGES() + 1, UNDEFINED),
+	  references(NUMBER_OF_ADDRESSABLE_PAGES() + 1, 0),
+	  fingerprint_of_content(NUMBER_OF_ADDRESSABLE_PAGES() + 1, UNDEFINED),
+	  content_of_fingerprint(),
+	  live_contents(),
+	  position_in_live_contents(NUMBER_OF_ADDRESSABLE_PAGES() + 1, UNDEFINED),
+	  released_content_ids(),
+	  next_content_id(0),
+	  next_unique_fingerprint(0),
+	  num_mapped_lbas(0), num_shared_contents(0), peak_index_size(0),
+	  num_app_writes(0), num_duplicate_writes(0), num_released_contents(0)
+{}
+
+// Returns false if the logical address has never been written
+bool Deduplication_Index::register_read_arrival(Event& read) {
+	long lba = read.get_logical_address();
+	if (content_of_lba[lba] == UNDEFINED) {
+		return false;
+	}
+	read.set_host_logical_address(lba);
+	read.set_logical_address(content_of_lba[lba]);
+	return true;
+}
+
+// A duplicate write becomes a noop that only updates the mapping. A unique write gets a content ID,
+// which it carries as its logical address inside the SSD.
+void Deduplication_Index::register_write_arrival(Event& write) {
+	long lba = write.get_logical_address();
+	long fingerprint = get_fingerprint(write);
+	write.set_fingerprint(fingerprint);
+	write.set_host_logical_address(lba);
+	num_app_writes++;
+
+	long content_id = UNDEFINED;
+	bool is_duplicate = content_of_fingerprint.count(fingerprint) == 1;
+	if (is_duplicate) {
+		content_id = content_of_fingerprint.at(fingerprint);
+		if (references[content_id] == 1) {
+			num_shared_contents++;
+		}
+		references[content_id]++;
+		write.set_noop(true);
+		num_duplicate_writes++;
+	}
+
+	// Releasing the old content first lets a unique overwrite reuse its content ID
+	long old_content_id = content_of_lba[lba];
+	if (old_content_id != UNDEFINED) {
+		remove_reference(old_content_id);
+	} else {
+		num_mapped_lbas++;
+	}
+
+	if (!is_duplicate) {
+		content_id = allocate_content_id();
+		references[content_id] = 1;
+		fingerprint_of_content[content_id] = fingerprint;
+		content_of_fingerprint[fingerprint] = content_id;
+		position_in_live_contents[content_id] = live_contents.size();
+		live_contents.push_back(content_id);
+		peak_index_size = max(peak_index_size, (long)content_of_fingerprint.size());
+		write.set_logical_address(content_id);
+	}
+	content_of_lba[lba] = content_id;
+}
+
+// The trim only updates the mapping. If the content is no longer referenced, its page is
+// invalidated when its content ID is reused, like for any other overwrite.
+void Deduplication_Index::register_trim_arrival(Event& trim) {
+	long lba = trim.get_logical_address();
+	trim.set_host_logical_address(lba);
+	trim.set_noop(true);
+	if (content_of_lba[lba] == UNDEFINED) {
+		return;
+	}
+	remove_reference(content_of_lba[lba]);
+	content_of_lba[lba] = UNDEFINED;
+	num_mapped_lbas--;
+}
+
+long Deduplication_Index::get_fingerprint(Event const& write) {
+	if (write.get_fingerprint() != UNDEFINED) {
+		return write.get_fingerprint();
+	}
+	// FNV-1a hash of the page. The top bit is dropped so that fingerprints are never negative
+	if (DEDUPLICATION_MODE == 2 && write.get_payload() != NULL) {
+		unsigned char const* data = (unsigned char const*) write.get_payload();
+		ulong hash = 14695981039346656037UL;
+		for (uint i = 0; i < PAGE_SIZE; i++) {
+			hash ^= data[i];
+			hash *= 1099511628211UL;
+		}
+		return hash >> 1;
+	}
+	if (!live_contents.empty() && random_number_generator() < DEDUP_RATIO) {
+		long content_id = live_contents[(long)(random_number_generator() * live_contents.size())];
+		return fingerprint_of_content[content_id];
+	}
+	return next_unique_fingerprint++;
+}
+
+// Released content IDs are reused first, and most recently released first. The write of the new content
+// then replaces the page of the released content, so a released page stays valid as briefly as possible.
+// Note that the write that releases a content often reuses its ID straight away.
+long Deduplication_Index::allocate_content_id() {
+	if (!released_content_ids.empty()) {
+		long content_id = released_content_ids.back();
+		released_content_ids.pop_back();
+		return content_id;
+	}
+	assert(next_content_id < (long)references.size());
+	return next_content_id++;
+}
+
+void Deduplication_Index::remove_reference(long content_id) {
+	assert(references[content_id] > 0);
+	references[content_id]--;
+	if (references[content_id] == 1) {
+		num_shared_contents--;
+	}
+	if (references[content_id] > 0) {
+		return;
+	}
+	content_of_fingerprint.erase(fingerprint_of_content[content_id]);
+	fingerprint_of_content[content_id] = UNDEFINED;
+	long last = live_contents.back();
+	position_in_live_contents[last] = position_in_live_contents[content_id];
+	live_contents[position_in_live_contents[content_id]] = last;
+	live_contents.pop_back();
+	position_in_live_contents[content_id] = UNDEFINED;
+	released_content_ids.push_back(content_id);
+	num_released_contents++;
+}
+
+// Every index entry holds a fingerprint, a content ID and a reference count.
+// The host to content mapping is an extra level of indirection on top of the page mapping table.
+void Deduplication_Index::print() const {
+	double write_reduction = num_app_writes == 0 ? 0 : num_duplicate_writes / (double) num_app_writes;
+	double dedup_ratio = live_contents.empty() ? 0 : num_mapped_lbas / (double) live_contents.size();
+	long index_bytes = peak_index_size * (DEDUP_FINGERPRINT_SIZE + 2 * sizeof(uint));
+	long mapping_bytes = num_mapped_lbas * sizeof(uint);
+	printf("deduplication:\n");
+	printf("\tapp writes:\t%ld\n", num_app_writes);
+	printf("\tduplicate writes:\t%ld\n", num_duplicate_writes);
+	printf("\twrite reduction:\t%f\n", write_reduction);
+	printf("\tmapped addresses:\t%ld\n", num_mapped_lbas);
+	printf("\tunique contents:\t%ld\n", (long) live_contents.size());
+	printf("\tshared contents:\t%ld\n", num_shared_contents);
+	printf("\tdedup ratio:\t%f\n", dedup_ratio);
+	printf("\treleased contents:\t%ld\n", num_released_contents);
+	printf("\treleased contents awaiting reuse:\t%ld\n", (long) released_content_ids.size());
+	printf("\tpeak index entries:\t%ld\n", peak_index_size);
+	printf("\tindex RAM (bytes):\t%ld\n", index_bytes);
+	printf("\textra mapping RAM (bytes):\t%ld\n", mapping_bytes);
+}
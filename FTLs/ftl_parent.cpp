@@ -3,7 +3,7 @@ using namespace ssd;
 
 
 FtlParent::FtlParent(Ssd *ssd, Block_manager_parent* bm)
-: ssd(ssd), scheduler(NULL), bm(bm), normal_stats("ftl_stats", 50000) {
+: ssd(ssd), scheduler(NULL), bm(bm), map_persistence(NULL), normal_stats("ftl_stats", 50000) {
 
 }
 
@@ -11,6 +11,7 @@ FtlParent::~FtlParent () {
 	if (normal_stats.num_mapping_reads > 0 || normal_stats.num_mapping_writes > 0) {
 		normal_stats.print();
 	}
+	delete map_persistence;
 }
 
 FtlParent::stats::stats(string name, long counter_limit) : num_mapping_reads(0), num_mapping_writes(0),
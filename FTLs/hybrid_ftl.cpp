@@ -0,0 +1,304 @@
+/*
+ * hybrid_ftl.cpp
+ *
+ * The write dispatching and merge machinery shared by the block-mapped FTLs with log blocks.
+ */
+
+#include <new>
+#include <assert.h>
+#include <stdio.h>
+#include <algorithm>
+#include "../ssd.h"
+
+using namespace ssd;
+
+Hybrid_FTL::group::group() :
+		pending_writes(),
+		num_writes_in_flight(0),
+		merge_requested(false),
+		being_merged(false),
+		waiting_for_space(false),
+		copies_left(),
+		copy_destination()
+{}
+
+Hybrid_FTL::Hybrid_FTL(Ssd *ssd, Block_manager_parent* bm, Migrator* migrator, int logical_blocks_per_group) :
+		FtlParent(ssd, bm),
+		LOGICAL_BLOCKS_PER_GROUP(logical_blocks_per_group),
+		NUM_RESERVED_BLOCKS(2 * SSD_SIZE * PACKAGE_SIZE),
+		migrator(migrator),
+		num_app_writes(0),
+		groups(NUMBER_OF_ADDRESSABLE_BLOCKS() / logical_blocks_per_group + 1),
+		groups_waiting_for_space(),
+		blocks_being_written(),
+		logical_addresses_being_written(),
+		num_merges_in_progress(0),
+		page_mapping(ssd, bm)
+{
+	if (GREED_SCALE > 0) {
+		printf("Warning: the parameter GREED_SCALE must be set to 0 for hybrid FTLs. We set it to 0 here on your behalf.\n");
+	}
+	GREED_SCALE = 0;
+	IS_FTL_PAGE_MAPPING = false;
+}
+
+Hybrid_FTL::~Hybrid_FTL() {
+	for (uint i = 0; i < groups.size(); i++) {
+		assert(groups[i].pending_writes.empty());
+	}
+}
+
+void Hybrid_FTL::read(Event *event) {
+	scheduler->schedule_event(event);
+}
+
+void Hybrid_FTL::write(Event *event) {
+	num_app_writes++;
+	int group_id = get_group(event->get_logical_address());
+	groups[group_id].pending_writes.push_back(event);
+	dispatch(group_id, event->get_current_time());
+}
+
+void Hybrid_FTL::trim(Event *event) {
+	printf("We don't allow trims for hybrid FTLs for now.\n");
+	assert(false);
+}
+
+// Writes to the same logical address are never in flight together, so that they cannot complete out of order
+void Hybrid_FTL::dispatch(int group_id, double time) {
+	group& g = groups[group_id];
+	while (!g.pending_writes.empty() && !g.merge_requested && !g.being_merged && !g.waiting_for_space) {
+		Event* write = g.pending_writes.front();
+		if (logical_addresses_being_written.count(write->get_logical_address()) == 1) {
+			return;
+		}
+		if (!choose_write_address(group_id, write)) {
+			return;
+		}
+		g.pending_writes.pop_front();
+		g.num_writes_in_flight++;
+		logical_addresses_being_written.insert(write->get_logical_address());
+		if (time > write->get_current_time()) {
+			write->incr_bus_wait_time(time - write->get_current_time());
+		}
+		scheduler->schedule_event(write);
+	}
+}
+
+bool Hybrid_FTL::take_page(Address& pointer, Event* write) {
+	assert(pointer.valid == PAGE && pointer.page < BLOCK_SIZE);
+	if (is_block_being_written(pointer)) {
+		return false;
+	}
+	blocks_being_written.insert(pointer.get_block_id());
+	write->set_address(pointer);
+	pointer.page++;
+	return true;
+}
+
+bool Hybrid_FTL::is_block_being_written(Address const& block) const {
+	return blocks_being_written.count(block.get_block_id()) == 1;
+}
+
+// Returns a free block on the given LUN, or on any LUN if lun is UNDEFINED. Only merges may take the reserved blocks.
+Address Hybrid_FTL::allocate_block(int lun, bool for_merge, double time) {
+	if (!for_merge && bm->get_num_free_blocks() <= NUM_RESERVED_BLOCKS) {
+		return Address();
+	}
+	Address block;
+	for (int i = 0; i < SSD_SIZE * PACKAGE_SIZE && block.valid == NONE; i++) {
+		int l = lun == UNDEFINED ? UNDEFINED : (lun + i) % (SSD_SIZE * PACKAGE_SIZE);
+		block = l == UNDEFINED ? bm->find_free_unused_block(time) : bm->find_free_unused_block(l / PACKAGE_SIZE, l % PACKAGE_SIZE, time);
+	}
+	if (block.valid == NONE) {
+		return Address();
+	}
+	block.valid = PAGE;
+	block.page = 0;
+	return block;
+}
+
+void Hybrid_FTL::request_merge(int group_id, double time) {
+	group& g = groups[group_id];
+	if (g.merge_requested || g.being_merged) {
+		return;
+	}
+	g.merge_requested = true;
+	num_merges_in_progress++;
+	if (g.num_writes_in_flight == 0) {
+		start_merge(group_id, time);
+	}
+}
+
+void Hybrid_FTL::wait_for_space(int group_id) {
+	if (!groups[group_id].waiting_for_space) {
+		groups[group_id].waiting_for_space = true;
+		groups_waiting_for_space.push_back(group_id);
+	}
+}
+
+// A merge that finds no block to copy into is tried again after the next erase
+void Hybrid_FTL::start_merge(int group_id, double time) {
+	group& g = groups[group_id];
+	g.being_merged = true;
+	if (!merge(group_id, time)) {
+		g.being_merged = false;
+		wait_for_space(group_id);
+		return;
+	}
+	g.merge_requested = false;
+	if (g.copies_left.empty()) {
+		finish_merge(group_id, time);
+	}
+}
+
+void Hybrid_FTL::copy_pages(int group_id, vector<long> const& logical_addresses, Address const& destination, double time) {
+	group& g = groups[group_id];
+	g.copies_left = deque<long>(logical_addresses.begin(), logical_addresses.end());
+	g.copy_destination = destination;
+	bm->subtract_from_available_for_new_writes(logical_addresses.size());
+	if (!g.copies_left.empty()) {
+		copy_next_page(group_id, time);
+	}
+}
+
+void Hybrid_FTL::copy_next_page(int group_id, double time) {
+	Event* read = new Event(READ, groups[group_id].copies_left.front(), 1, time);
+	read->set_garbage_collection_op(true);
+	set_read_address(*read);
+	scheduler->schedule_event(read);
+}
+
+void Hybrid_FTL::finish_merge(int group_id, double time) {
+	group& g = groups[group_id];
+	g.being_merged = false;
+	num_merges_in_progress--;
+	register_merge_completion(group_id, g.copy_destination, time);
+	g.copy_destination = Address();
+	dispatch(group_id, time);
+	dispatch_groups_waiting_for_space(time);
+}
+
+void Hybrid_FTL::dispatch_groups_waiting_for_space(double time) {
+	int num_waiting = groups_waiting_for_space.size();
+	for (int i = 0; i < num_waiting; i++) {
+		int group_id = groups_waiting_for_space.front();
+		groups_waiting_for_space.pop_front();
+		group& g = groups[group_id];
+		g.waiting_for_space = false;
+		if (g.merge_requested && g.num_writes_in_flight == 0) {
+			start_merge(group_id, time);
+		} else {
+			dispatch(group_id, time);
+		}
+	}
+}
+
+// The blocks a merge empties are handed to the migrator, which erases them once their live pages are gone
+void Hybrid_FTL::retire_block(Address const& block, double time) {
+	assert(!is_block_being_written(block));
+	Address a = block;
+	a.valid = BLOCK;
+	a.page = 0;
+	bm->close_unfilled_block(a, time);
+	migrator->update_structures(a, time);
+}
+
+vector<long> Hybrid_FTL::get_live_logical_addresses(Address const& block) const {
+	vector<long> logical_addresses;
+	Address a = block;
+	a.valid = PAGE;
+	for (a.page = 0; a.page < BLOCK_SIZE; a.page++) {
+		long logical_address = page_mapping.get_logical_address(a.get_linear_address());
+		if (logical_address != UNDEFINED) {
+			logical_addresses.push_back(logical_address);
+		}
+	}
+	return logical_addresses;
+}
+
+bool Hybrid_FTL::is_mapped(long logical_address) const {
+	return page_mapping.get_physical_address(logical_address).valid == PAGE;
+}
+
+bool Hybrid_FTL::is_idle(int group_id) const {
+	group const& g = groups[group_id];
+	return !g.merge_requested && !g.being_merged && g.num_writes_in_flight == 0;
+}
+
+bool Hybrid_FTL::is_merging(int group_id) const {
+	return groups[group_id].merge_requested || groups[group_id].being_merged;
+}
+
+void Hybrid_FTL::register_write_completion(Event const& event, enum status result) {
+	page_mapping.register_write_completion(event, result);
+	blocks_being_written.erase(event.get_address().get_block_id());
+	int group_id = get_group(event.get_logical_address());
+	group& g = groups[group_id];
+	double time = event.get_current_time();
+
+	if (event.is_garbage_collection_op()) {
+		g.copies_left.pop_front();
+		if (g.copies_left.empty()) {
+			finish_merge(group_id, time);
+		} else {
+			copy_next_page(group_id, time);
+		}
+		return;
+	}
+
+	g.num_writes_in_flight--;
+	logical_addresses_being_written.erase(event.get_logical_address());
+	if (is_merge_due(group_id)) {
+		request_merge(group_id, time);
+	}
+	if (g.merge_requested && g.num_writes_in_flight == 0 && !g.waiting_for_space) {
+		start_merge(group_id, time);
+	}
+	dispatch(group_id, time);
+}
+
+// When a page being copied has been read, it is written to the next page of the merge's destination
+void Hybrid_FTL::register_read_completion(Event const& event, enum status result) {
+	page_mapping.register_read_completion(event, result);
+	if (!event.is_garbage_collection_op()) {
+		return;
+	}
+	group& g = groups[get_group(event.get_logical_address())];
+	assert(!g.copies_left.empty() && g.copies_left.front() == event.get_logical_address());
+	Event* write = new Event(WRITE, event.get_logical_address(), 1, event.get_current_time());
+	write->set_garbage_collection_op(true);
+	bool taken = take_page(g.copy_destination, write);
+	assert(taken);
+	scheduler->schedule_event(write);
+}
+
+void Hybrid_FTL::register_trim_completion(Event & event) {
+	page_mapping.register_trim_completion(event);
+}
+
+void Hybrid_FTL::register_erase_completion(Event & event) {
+	dispatch_groups_waiting_for_space(event.get_current_time());
+}
+
+long Hybrid_FTL::get_logical_address(uint physical_address) const {
+	return page_mapping.get_logical_address(physical_address);
+}
+
+Address Hybrid_FTL::get_physical_address(uint logical_address) const {
+	return page_mapping.get_physical_address(logical_address);
+}
+
+void Hybrid_FTL::set_replace_address(Event& event) const {
+	page_mapping.set_replace_address(event);
+}
+
+void Hybrid_FTL::set_read_address(Event& event) const {
+	page_mapping.set_read_address(event);
+}
+
+void Hybrid_FTL::print_merge_cost() const {
+	printf("\tapp writes:\t%ld\n", num_app_writes);
+	printf("\tmerges:\t%ld\n", migrator->get_num_merges());
+	printf("\tmerge page copies per app write:\t%f\n", num_app_writes == 0 ? 0 : migrator->get_num_merge_page_copies() / (double) num_app_writes);
+}
@@ -0,0 +1,124 @@
+/*
+ * learned_ftl.cpp
+ *
+ * A DFTL that keeps its translation pages in RAM as piecewise linear models.
+ */
+
+#include <new>
+#include <assert.h>
+#include <stdio.h>
+#include <math.h>
+#include <limits>
+#include <algorithm>
+#include "../ssd.h"
+
+using namespace ssd;
+
+#define SEGMENT_SIZE 8 // bytes taken by a segment: start LBA, length, slope and first physical page
+
+Learned_FTL::Learned_FTL(Ssd *ssd, Block_manager_parent* bm) :
+		DFTL(ssd, bm),
+		segments(mapping_pages.size()),
+		num_segments(0),
+		num_modelled_entries(0),
+		num_predicted_reads(0),
+		num_mispredicted_reads(0)
+{}
+
+Learned_FTL::~Learned_FTL() {
+	print();
+}
+
+// Fits the entries of the translation page just written with as few segments as the error bound allows.
+// Physical pages are numbered across LUNs first, so that a sequential write falls on a line.
+// Each segment keeps the range of slopes that predicts all of its entries within the bound,
+// and a new segment starts when an entry would leave that range empty.
+void Learned_FTL::register_translation_page_write(long translation_page_id) {
+	vector<int> const& physical_pages = mapping_pages[translation_page_id].physical_pages;
+	vector<segment>& fitted = segments[translation_page_id];
+	for (auto s : fitted) {
+		num_modelled_entries -= s.num_entries;
+	}
+	num_segments -= fitted.size();
+	fitted.clear();
+
+	long first_key_in_translation_page = translation_page_id * ENTRIES_PER_TRANSLATION_PAGE;
+	double min_slope = 0, max_slope = 0;
+	for (uint i = 0; i < physical_pages.size(); i++) {
+		if (physical_pages[i] == UNDEFINED) {
+			continue;
+		}
+		long lba = first_key_in_translation_page + i;
+		long model_address = get_striped_page_number(physical_pages[i]);
+		if (!fitted.empty()) {
+			segment& current = fitted.back();
+			double distance = lba - current.first_lba;
+			double low = max(min_slope, (model_address - LEARNED_FTL_ERROR_BOUND - current.first_model_address) / distance);
+			double high = min(max_slope, (model_address + LEARNED_FTL_ERROR_BOUND - current.first_model_address) / distance);
+			if (low <= high) {
+				min_slope = low;
+				max_slope = high;
+				current.slope = (low + high) / 2;
+				current.num_entries++;
+				continue;
+			}
+		}
+		segment s = { lba, model_address, 0, 1 };
+		fitted.push_back(s);
+		min_slope = -numeric_limits<double>::infinity();
+		max_slope = numeric_limits<double>::infinity();
+	}
+	num_segments += fitted.size();
+	for (auto s : fitted) {
+		num_modelled_entries += s.num_entries;
+	}
+	if (num_modelled_entries > 0) {
+		set_cache_ram_per_clean_entry(num_segments * SEGMENT_SIZE / (double) num_modelled_entries);
+	}
+}
+
+bool Learned_FTL::is_prediction_exact(long lba) const {
+	long translation_page_id = lba / ENTRIES_PER_TRANSLATION_PAGE;
+	vector<int> const& physical_pages = mapping_pages[translation_page_id].physical_pages;
+	vector<segment> const& fitted = segments[translation_page_id];
+	long offset = lba - translation_page_id * ENTRIES_PER_TRANSLATION_PAGE;
+	if (physical_pages.empty() || physical_pages[offset] == UNDEFINED || fitted.empty()) {
+		return true;
+	}
+	uint i = 0;
+	while (i + 1 < fitted.size() && fitted[i + 1].first_lba <= lba) {
+		i++;
+	}
+	segment const& s = fitted[i];
+	long prediction = s.first_model_address + lround(s.slope * (lba - s.first_lba));
+	return prediction == get_striped_page_number(physical_pages[offset]);
+}
+
+// The penalty is added once, before the read transfer leaves the controller
+void Learned_FTL::set_read_address(Event& event) const {
+	DFTL::set_read_address(event);
+	if (event.is_mapping_op() || event.is_garbage_collection_op() || event.get_event_type() != READ_TRANSFER
+			|| event.get_execution_time() != 0 || event.get_address().valid != PAGE || cache->is_dirty(event.get_logical_address())) {
+		return;
+	}
+	num_predicted_reads++;
+	if (!is_prediction_exact(event.get_logical_address())) {
+		num_mispredicted_reads++;
+		event.incr_execution_time(PAGE_READ_DELAY);
+	}
+}
+
+void Learned_FTL::print() const {
+	printf("learned FTL:\n");
+	printf("\terror bound:\t%d\n", LEARNED_FTL_ERROR_BOUND);
+	printf("\tmodelled entries:\t%ld\n", num_modelled_entries);
+	printf("\tsegments:\t%ld\n", num_segments);
+	printf("\tentries per segment:\t%f\n", num_segments == 0 ? 0 : num_modelled_entries / (double) num_segments);
+	printf("\tRAM for the modelled entries as a page-level map (bytes):\t%ld\n", num_modelled_entries * MAPPING_ENTRY_SIZE);
+	printf("\tRAM for the modelled entries as segments (bytes):\t%ld\n", num_segments * SEGMENT_SIZE);
+	printf("\tmapping cache RAM (bytes):\t%ld\n", ftl_cache::CACHED_ENTRIES_THRESHOLD * (long) MAPPING_ENTRY_SIZE);
+	printf("\tmapping cache capacity (entries):\t%d\n", cache->get_capacity());
+	printf("\tpredicted reads:\t%ld\n", num_predicted_reads);
+	printf("\tmispredicted reads:\t%ld\n", num_mispredicted_reads);
+	printf("\tmisprediction rate:\t%f\n", num_predicted_reads == 0 ? 0 : num_mispredicted_reads / (double) num_predicted_reads);
+}
@@ -0,0 +1,106 @@
+/*
+ * map_persistence.cpp
+ *
+ * Writes the mapping updates of an FTL to a journal on flash, and checkpoints its map periodically.
+ */
+
+#include <new>
+#include <assert.h>
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include "../ssd.h"
+
+using namespace ssd;
+
+#define CHECKPOINT_ENTRY_SIZE 4 // bytes taken by an entry of a checkpoint: the physical page of a logical page
+#define JOURNAL_ENTRY_SIZE 8 // bytes taken by an entry of the journal: a logical page and its new physical page
+
+Map_Persistence::Map_Persistence(FtlParent* ftl, IOScheduler* scheduler) :
+		ftl(ftl),
+		scheduler(scheduler),
+		entries_per_journal_page(PAGE_SIZE / JOURNAL_ENTRY_SIZE),
+		entries_per_checkpoint_page(PAGE_SIZE / CHECKPOINT_ENTRY_SIZE),
+		checkpoint_start(NUMBER_OF_ADDRESSABLE_PAGES() * OVER_PROVISIONING_FACTOR),
+		checkpoint_capacity(ceil(NUMBER_OF_ADDRESSABLE_PAGES() / (double) entries_per_checkpoint_page)),
+		journal_start(checkpoint_start + checkpoint_capacity),
+		journal_capacity(ceil(MAP_CHECKPOINT_INTERVAL / (double) entries_per_journal_page) + 1),
+		num_buffered_entries(0),
+		num_updates_since_checkpoint(0), num_journal_pages_since_checkpoint(0),
+		num_checkpoint_pages(0),
+		num_updates(0), num_checkpoints(0), num_journal_page_writes(0), num_checkpoint_page_writes(0)
+{
+	// The translation pages of DFTL take the logical addresses at the top of the SSD
+	assert(journal_start + journal_capacity < NUMBER_OF_ADDRESSABLE_PAGES() - NUMBER_OF_ADDRESSABLE_PAGES() / DFTL::ENTRIES_PER_TRANSLATION_PAGE);
+}
+
+Map_Persistence::~Map_Persistence() {
+	print();
+}
+
+bool Map_Persistence::is_persistence_page(long logical_address) const {
+	return logical_address >= checkpoint_start && logical_address < journal_start + journal_capacity;
+}
+
+// The pages the map persistence writes itself, also when GC moves them, are not journaled
+void Map_Persistence::register_mapping_update(long logical_address, double time) {
+	if (is_persistence_page(logical_address)) {
+		return;
+	}
+	num_updates++;
+	num_updates_since_checkpoint++;
+	if (++num_buffered_entries == entries_per_journal_page) {
+		write_page(journal_start + num_journal_pages_since_checkpoint % journal_capacity, time);
+		num_journal_pages_since_checkpoint++;
+		num_journal_page_writes++;
+		num_buffered_entries = 0;
+	}
+	if (num_updates_since_checkpoint >= MAP_CHECKPOINT_INTERVAL) {
+		checkpoint(time);
+	}
+}
+
+void Map_Persistence::write_page(long logical_address, double time) {
+	Event* write = new Event(WRITE, logical_address, 1, time);
+	write->set_mapping_op(true);
+	scheduler->schedule_event(write);
+}
+
+// The checkpoint covers the entries still buffered for the journal, so they are dropped
+void Map_Persistence::checkpoint(double time) {
+	num_checkpoint_pages = ceil(ftl->get_num_entries_to_checkpoint() / (double) entries_per_checkpoint_page);
+	assert(num_checkpoint_pages <= checkpoint_capacity);
+	for (long i = 0; i < num_checkpoint_pages; i++) {
+		write_page(checkpoint_start + i, time);
+	}
+	num_checkpoint_page_writes += num_checkpoint_pages;
+	num_checkpoints++;
+	num_updates_since_checkpoint = 0;
+	num_journal_pages_since_checkpoint = 0;
+	num_buffered_entries = 0;
+}
+
+// Mounting reads the pages spread over all LUNs. Each LUN reads its share one page after the other,
+// and each channel transfers the share of its LUNs.
+double Map_Persistence::get_recovery_time(long num_pages) const {
+	if (num_pages == 0) {
+		return 0;
+	}
+	double read_time = ceil(num_pages / (double) (SSD_SIZE * PACKAGE_SIZE)) * PAGE_READ_DELAY;
+	double transfer_time = ceil(num_pages / (double) SSD_SIZE) * (BUS_CTRL_DELAY + BUS_DATA_DELAY);
+	return max(read_time, transfer_time) + PAGE_READ_DELAY + BUS_CTRL_DELAY + BUS_DATA_DELAY;
+}
+
+void Map_Persistence::print() const {
+	long num_persistence_writes = num_journal_page_writes + num_checkpoint_page_writes;
+	printf("map persistence:\n");
+	printf("\tcheckpoint interval (mapping updates):\t%d\n", MAP_CHECKPOINT_INTERVAL);
+	printf("\tmapping updates:\t%ld\n", num_updates);
+	printf("\tcheckpoints:\t%ld\n", num_checkpoints);
+	printf("\tcheckpoint size (pages):\t%ld\n", num_checkpoint_pages);
+	printf("\tjournal page writes:\t%ld\n", num_journal_page_writes);
+	printf("\tcheckpoint page writes:\t%ld\n", num_checkpoint_page_writes);
+	printf("\tpersistence writes per mapping update:\t%f\n", num_updates == 0 ? 0 : num_persistence_writes / (double) num_updates);
+	printf("\tmount time now (us):\t%f\n", get_recovery_time(num_checkpoint_pages + num_journal_pages_since_checkpoint));
+	printf("\tmount time just before a checkpoint (us):\t%f\n", get_recovery_time(num_checkpoint_pages + journal_capacity - 1));
+}
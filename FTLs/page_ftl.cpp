@@ -28,7 +28,8 @@ using namespace ssd;
 FtlImpl_Page::FtlImpl_Page(Ssd *ssd, Block_manager_parent* bm):
 	FtlParent(ssd, bm),
 	logical_to_physical_map(NUMBER_OF_ADDRESSABLE_PAGES() + 1, UNDEFINED),
-	physical_to_logical_map(NUMBER_OF_ADDRESSABLE_PAGES() + 1, UNDEFINED)
+	physical_to_logical_map(NUMBER_OF_ADDRESSABLE_PAGES() + 1, UNDEFINED),
+	dedup(DEDUPLICATION_MODE > 0 ? new Deduplication_Index() : NULL)
 {
 	IS_FTL_PAGE_MAPPING = true;
 }
@@ -36,26 +37,46 @@ FtlImpl_Page::FtlImpl_Page(Ssd *ssd, Block_manager_parent* bm):
 FtlImpl_Page::FtlImpl_Page() :
 	FtlParent(),
 	logical_to_physical_map(NUMBER_OF_ADDRESSABLE_PAGES() + 1, UNDEFINED),
-	physical_to_logical_map(NUMBER_OF_ADDRESSABLE_PAGES() + 1, UNDEFINED)
+	physical_to_logical_map(NUMBER_OF_ADDRESSABLE_PAGES() + 1, UNDEFINED),
+	dedup(DEDUPLICATION_MODE > 0 ? new Deduplication_Index() : NULL)
 {
 	IS_FTL_PAGE_MAPPING = true;
 }
 
 FtlImpl_Page::~FtlImpl_Page(void)
-{}
+{
+	if (dedup != NULL) {
+		dedup->print();
+		delete dedup;
+	}
+}
 
 void FtlImpl_Page::read(Event *event)
 {
+	if (dedup != NULL && !dedup->register_read_arrival(*event)) {
+		fprintf(stderr, "You are trying to read logical address %d, but this address has not been written so far.\n", event->get_logical_address());
+		assert(false);
+	}
 	scheduler->schedule_event(event);
 }
 
 void FtlImpl_Page::write(Event *event)
 {
+	if (dedup != NULL) {
+		dedup->register_write_arrival(*event);
+	}
 	scheduler->schedule_event(event);
 }
 
 void FtlImpl_Page::trim(Event *event)
 {
+	if (dedup != NULL) {
+		dedup->register_trim_arrival(*event);
+	}
+	// A range trim is journaled as one entry
+	if (map_persistence != NULL) {
+		map_persistence->register_mapping_update(event->get_logical_address(), event->get_current_time());
+	}
 	scheduler->schedule_event(event);
 }
 
@@ -75,6 +96,10 @@ void FtlImpl_Page::register_write_completion(Event const& event, enum status res
 		long old_phys_addr = event.get_replace_address().get_linear_address();
 		physical_to_logical_map[old_phys_addr] = UNDEFINED;
 	}
+
+	if (map_persistence != NULL) {
+		map_persistence->register_mapping_update(logi_addr, event.get_current_time());
+	}
 }
 
 void FtlImpl_Page::register_read_completion(Event const& event, enum status result) {
@@ -88,6 +113,22 @@ void FtlImpl_Page::register_trim_completion(Event & event) {
 	physical_to_logical_map[phys_addr] = UNDEFINED;
 }
 
+// Returns the page the logical address was mapped to, if any
+Address FtlImpl_Page::unmap(long logical_address) {
+	long phys_addr = logical_to_physical_map[logical_address];
+	if (phys_addr == UNDEFINED) {
+		return Address();
+	}
+	logical_to_physical_map[logical_address] = UNDEFINED;
+	physical_to_logical_map[phys_addr] = UNDEFINED;
+	return Address(phys_addr, PAGE);
+}
+
+// The whole table of the logical pages exposed to the host is checkpointed
+long FtlImpl_Page::get_num_entries_to_checkpoint() const {
+	return NUMBER_OF_ADDRESSABLE_PAGES() * OVER_PROVISIONING_FACTOR;
+}
+
 long FtlImpl_Page::get_logical_address(uint physical_address) const {
 	return physical_to_logical_map[physical_address];
 }
@@ -106,7 +147,12 @@ void FtlImpl_Page::set_replace_address(Event& event) const {
 
 void FtlImpl_Page::set_read_address(Event& event) const {
 	Address target = get_physical_address(event.get_logical_address());
-	if (target.valid == NONE) {
+	// A content ID without a page is still being written. The read waits for that write in the scheduler,
+	// and its address is looked up again once the write is done.
+	if (target.valid == NONE && dedup != NULL) {
+		return;
+	}
+	else if (target.valid == NONE) {
 		fprintf(stderr, "You are trying to read logical address %d, but this address does not have a corresponding physical page in the mapping table.\n", event.get_logical_address());
 		fprintf(stderr, "It is most likely that nothing has been written to this address so far.\n");
 		assert(false);
@@ -119,4 +165,8 @@ void FtlImpl_Page::set_read_address(Event& event) const {
 	}
 }
 
-
+void FtlImpl_Page::print() const {
+	if (dedup != NULL) {
+		dedup->print();
+	}
+}
@@ -16,20 +16,117 @@ using namespace ssd;
 
 int ftl_cache::CACHED_ENTRIES_THRESHOLD = 10000;
 
+ftl_cache::ftl_cache()
+	: slots(),
+	  slot_of_key(NUMBER_OF_ADDRESSABLE_PAGES() + 1, UNDEFINED),
+	  num_prefetched_entries(0),
+	  num_prefetch_hits(0),
+	  num_unused_prefetches(0),
+	  free_slots(),
+	  num_dirty_entries_per_translation_page(NUMBER_OF_ADDRESSABLE_PAGES() / DFTL::ENTRIES_PER_TRANSLATION_PAGE + 1, 0),
+	  num_entries(0),
+	  capacity(CACHED_ENTRIES_THRESHOLD)
+{
+	for (int i = 0; i < 2; i++) {
+		heads[i] = tails[i] = UNDEFINED;
+		list_sizes[i] = 0;
+	}
+}
+
+ftl_cache::entry& ftl_cache::insert(int key) {
+	assert(slot_of_key[key] == UNDEFINED);
+	int slot;
+	if (free_slots.empty()) {
+		slot = slots.size();
+		slots.push_back(entry());
+	} else {
+		slot = free_slots.back();
+		free_slots.pop_back();
+		slots[slot] = entry();
+	}
+	slots[slot].key = key;
+	slot_of_key[key] = slot;
+	num_entries++;
+	return slots[slot];
+}
+
+void ftl_cache::erase(int key) {
+	int slot = slot_of_key[key];
+	unlink(slot);
+	if (slots[slot].prefetched) {
+		num_unused_prefetches++;
+	}
+	slots[slot].key = UNDEFINED;
+	slot_of_key[key] = UNDEFINED;
+	free_slots.push_back(slot);
+	num_entries--;
+}
+
+// Appends the entry to the tail of an eviction list
+void ftl_cache::link(int slot, int list) {
+	entry& e = slots[slot];
+	e.list = list;
+	e.prev = tails[list];
+	e.next = UNDEFINED;
+	if (tails[list] == UNDEFINED) {
+		heads[list] = slot;
+	} else {
+		slots[tails[list]].next = slot;
+	}
+	tails[list] = slot;
+	list_sizes[list]++;
+	if (list == DIRTY_LIST) {
+		change_num_dirty_entries(e.key, 1);
+	}
+}
+
+void ftl_cache::unlink(int slot) {
+	entry& e = slots[slot];
+	if (e.list == NO_LIST) {
+		return;
+	}
+	if (e.prev == UNDEFINED) {
+		heads[e.list] = e.next;
+	} else {
+		slots[e.prev].next = e.next;
+	}
+	if (e.next == UNDEFINED) {
+		tails[e.list] = e.prev;
+	} else {
+		slots[e.next].prev = e.prev;
+	}
+	list_sizes[e.list]--;
+	if (e.list == DIRTY_LIST) {
+		change_num_dirty_entries(e.key, -1);
+	}
+	e.list = NO_LIST;
+	e.prev = e.next = UNDEFINED;
+}
+
+void ftl_cache::move_to_list(int slot, int list) {
+	unlink(slot);
+	link(slot, list);
+}
+
+// Counts the dirty entries of each translation page, so that write-back can favour dense translation pages
+void ftl_cache::change_num_dirty_entries(int key, int change) {
+	num_dirty_entries_per_translation_page[key / DFTL::ENTRIES_PER_TRANSLATION_PAGE] += change;
+}
+
 void ftl_cache::register_write_arrival(Event const& event)
 {
 	int la = event.get_logical_address();
-	if (cached_mapping_table.count(la) == 1) {
-		entry& e = cached_mapping_table.at(la);
+	if (contains(la)) {
+		entry& e = slots[slot_of_key[la]];
 		e.hotness++;
 		e.fixed++;
+		e.prefetched = false;
 	}
 	else if (!event.is_mapping_op()) {
-		entry e;
+		entry& e = insert(la);
 		e.fixed = 1;
 		e.hotness = 1;
 		e.synch_flag = false;
-		cached_mapping_table[la] = e;
 	}
 	else {
 		assert(false);
@@ -37,53 +134,71 @@ void ftl_cache::register_write_arrival(Event const& event)
 }
 
 void ftl_cache::handle_read_dependency(Event* e) {
-	if (cached_mapping_table.count(e->get_logical_address()) == 0) {
-		ftl_cache::entry entry;
+	int la = e->get_logical_address();
+	if (!contains(la)) {
+		ftl_cache::entry& entry = insert(la);
 		entry.hotness++;
 		entry.synch_flag = true;
-		cached_mapping_table[e->get_logical_address()] = entry;
-		eviction_queue_clean.push(e->get_logical_address());
+		link(slot_of_key[la], CLEAN_LIST);
 	}
 	else {
-		ftl_cache::entry& entry = cached_mapping_table.at(e->get_logical_address());
+		ftl_cache::entry& entry = slots[slot_of_key[la]];
 		entry.hotness++;
 	}
 }
 
 bool ftl_cache::register_read_arrival(Event* app_read) {
 	int la = app_read->get_logical_address();
-	if (cached_mapping_table.count(la) == 1) {
-		ftl_cache::entry& e = cached_mapping_table.at(la);
-		e.hotness++;
+	if (contains(la)) {
+		ftl_cache::entry& e = slots[slot_of_key[la]];
+		// The first read of a prefetched entry is the one it was fetched for, so it does not make the entry hotter
+		if (e.prefetched) {
+			e.prefetched = false;
+			num_prefetch_hits++;
+		} else {
+			e.hotness++;
+		}
 		return true;
 	}
 	return false;
 }
 
+// A prefetched entry gets the same second chance as an entry read on demand
+void ftl_cache::register_prefetch(int key) {
+	assert(!contains(key));
+	entry& e = insert(key);
+	e.hotness = 1;
+	e.synch_flag = true;
+	e.prefetched = true;
+	link(slot_of_key[key], CLEAN_LIST);
+	num_prefetched_entries++;
+}
+
 void ftl_cache::register_write_completion(Event const& event) {
 	assert(!event.is_mapping_op());
+	int la = event.get_logical_address();
 	if (event.is_garbage_collection_op() && !event.is_original_application_io()) {
-		if (cached_mapping_table.count(event.get_logical_address()) == 0) {
-			entry e;
+		if (!contains(la)) {
+			entry& e = insert(la);
 			e.timestamp = event.get_current_time();
 			e.dirty = true;
 			e.synch_flag = true;
-			cached_mapping_table[event.get_logical_address()] = e;
-			eviction_queue_dirty.push(event.get_logical_address());
 		}
 		else {
-			entry& e = cached_mapping_table.at(event.get_logical_address());
+			entry& e = slots[slot_of_key[la]];
 			e.dirty = true;
 			e.timestamp = event.get_current_time();
 			e.fixed = 0;
 		}
+		move_to_list(slot_of_key[la], DIRTY_LIST);
 	}
 	else if (event.is_original_application_io()) {
-		entry& e = cached_mapping_table.at(event.get_logical_address());
+		assert(contains(la));
+		entry& e = slots[slot_of_key[la]];
 		e.fixed = 0;
 		e.dirty = true;
-		eviction_queue_dirty.push(event.get_logical_address());
 		e.timestamp = event.get_current_time();
+		move_to_list(slot_of_key[la], DIRTY_LIST);
 	}
 	else {
 		assert(false);  // just since I'm not immediately sure what should happen here
@@ -91,35 +206,25 @@ void ftl_cache::register_write_completion(Event const& event) {
 	//try_clear_space_in_mapping_cache(event.get_current_time());
 }
 
-void ftl_cache::iterate(long& victim_key, entry& victim_entry, bool allow_choosing_dirty) {
-	queue<long>& queue = allow_choosing_dirty ? eviction_queue_dirty : eviction_queue_clean;
-	for (int i = 0; i < queue.size(); i++) {
-		long addr = queue.front();
-		queue.pop();
-		if (cached_mapping_table.count(addr) == 0) {
-			continue;
-		}
-		entry& e = cached_mapping_table.at(addr);
-		if (!allow_choosing_dirty && e.dirty) {
-			eviction_queue_dirty.push(addr);
-		}
-		else if (allow_choosing_dirty && !e.dirty) {
-			eviction_queue_clean.push(addr);
-		}
-		else if (!e.fixed && e.hotness == 0) {
-			victim_key = addr;
-			victim_entry = e;
+// Makes at most one pass around the clean or dirty list. Entries that are fixed or still hot cool down by one
+// and go to the back of the list. A dirty victim goes to the back too, since it stays cached until written back.
+void ftl_cache::iterate(long& victim_key, bool allow_choosing_dirty) {
+	int list = allow_choosing_dirty ? DIRTY_LIST : CLEAN_LIST;
+	int num_entries_in_list = list_sizes[list];
+	for (int i = 0; i < num_entries_in_list; i++) {
+		int slot = heads[list];
+		entry& e = slots[slot];
+		move_to_list(slot, list);
+		if (!e.fixed && e.hotness == 0) {
+			victim_key = e.key;
 			return;
 		}
-		else if (e.dirty == allow_choosing_dirty) {
-			e.hotness = e.hotness == 0 ? 0 : e.hotness - 1;
-			queue.push(addr);
-		}
+		e.hotness = e.hotness == 0 ? 0 : e.hotness - 1;
 	}
 }
 
 void ftl_cache::clear_clean_entries(double time) {
-	while (cached_mapping_table.size() >= CACHED_ENTRIES_THRESHOLD && erase_victim(time, false) != UNDEFINED);
+	while (num_entries >= capacity && erase_victim(time, false) != UNDEFINED);
 }
 
 int ftl_cache::choose_dirty_victim(double time) {
@@ -127,32 +232,42 @@ int ftl_cache::choose_dirty_victim(double time) {
 }
 
 bool ftl_cache::mark_clean(int key, double time) {
-	if (cached_mapping_table.count(key) == 0) {
+	if (!contains(key)) {
 		return false;
 	}
-	ftl_cache::entry& e = cached_mapping_table.at(key);
+	ftl_cache::entry& e = slots[slot_of_key[key]];
 	bool was_dirty = e.dirty;
 	assert(e.fixed >= 0);
 	if (e.timestamp <= time && e.hotness == 0 && e.fixed == 0) {
-		cached_mapping_table.erase(key);
+		erase(key);
 	}
 	else if (e.timestamp <= time && e.dirty) {
 		e.dirty = false;
+		move_to_list(slot_of_key[key], CLEAN_LIST);
 	}
 	return was_dirty;
 }
 
 bool ftl_cache::contains(int key) const {
-	return cached_mapping_table.count(key) == 1;
+	return key >= 0 && key < slot_of_key.size() && slot_of_key[key] != UNDEFINED;
 }
 
 void ftl_cache::set_synchronized(int key) {
-	if (cached_mapping_table.count(key) == 1) {
-		ftl_cache::entry& e = cached_mapping_table.at(key);
+	if (contains(key)) {
+		ftl_cache::entry& e = slots[slot_of_key[key]];
 		e.synch_flag = true;
 	}
 }
 
+bool ftl_cache::is_dirty(int key) const {
+	return contains(key) && slots[slot_of_key[key]].dirty;
+}
+
+bool ftl_cache::is_synchronized(int key) const {
+	assert(contains(key));
+	return slots[slot_of_key[key]].synch_flag;
+}
+
 void flash_resident_page_ftl::update_bitmap(vector<bool>& bitmap, Address block_addr) {
 	int block_id = block_addr.get_block_id();
 	Block* block = ssd->get_package(block_addr.package)->get_die(block_addr.die)->get_plane(block_addr.plane)->get_block(block_addr.block);
@@ -185,35 +300,17 @@ void flash_resident_page_ftl::set_synchronized(int logical_address) {
 
 // Uses a clock entry replacement policy
 int ftl_cache::erase_victim(double time, bool allow_flushing_dirty) {
-	//printf("flush called. num dirty: %d     cache size: %d\n", get_num_dirty_entries(), cached_mapping_table.size());
-	// start at a given location
-	// find first entry with hotness 0 and make that the target, or make full traversal and identify least hot entry
 	long victim = UNDEFINED;
-	entry victim_entry;
-	victim_entry.hotness = SHRT_MAX;
+	iterate(victim, allow_flushing_dirty);
 
-	iterate(victim, victim_entry, allow_flushing_dirty);
-
-	if (victim == -1) {
+	if (victim == UNDEFINED) {
 		//printf("Warning, could not find a victim to flush from cache\n");
 		return UNDEFINED;
 	}
 
 	// if entry is clean, just erase it. Otherwise, need some mapping IOs.
-	if (!victim_entry.dirty) {
-		//printf("erase %d\n", victim);
-		cached_mapping_table.erase(victim);
-		return victim;
+	if (!allow_flushing_dirty) {
+		erase(victim);
 	}
 	return victim;
 }
-
-int ftl_cache::get_num_dirty_entries() const {
-	int num_dirty = 0;
-	for (auto i : cached_mapping_table) {
-		if (i.second.dirty) {
-			num_dirty++;
-		}
-	}
-	return num_dirty;
-}
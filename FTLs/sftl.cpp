@@ -0,0 +1,129 @@
+/*
+ * sftl.cpp
+ *
+ * A DFTL that caches translation pages whole, compressed as runs of consecutive physical pages.
+ */
+
+#include <new>
+#include <assert.h>
+#include <stdio.h>
+#include <algorithm>
+#include <stdlib.h>
+#include "../ssd.h"
+
+using namespace ssd;
+
+#define RUN_SIZE 6 // bytes taken by a run: its first physical page and its length
+#define MAX_DELTA 127 // the largest step between the physical pages of two LBAs in a run that a delta byte can hold
+
+SFTL::SFTL(Ssd *ssd, Block_manager_parent* bm) :
+		DFTL(ssd, bm),
+		num_runs(mapping_pages.size(), 0),
+		num_deltas(mapping_pages.size(), 0),
+		num_mapped_entries(mapping_pages.size(), 0),
+		total_cached_size(0),
+		total_mapped_entries(0),
+		num_compressible_pages(0),
+		num_whole_page_loads(0),
+		num_entries_loaded(0)
+{}
+
+SFTL::~SFTL() {
+	print();
+}
+
+bool SFTL::is_compressible(long translation_page_id) const {
+	return num_mapped_entries[translation_page_id] > 0 &&
+			get_compressed_size(translation_page_id) <= SFTL_COMPRESSION_THRESHOLD * num_mapped_entries[translation_page_id] * MAPPING_ENTRY_SIZE;
+}
+
+int SFTL::get_compressed_size(long translation_page_id) const {
+	return num_runs[translation_page_id] * RUN_SIZE + num_deltas[translation_page_id];
+}
+
+// A translation page that does not compress well is cached entry by entry, as in DFTL
+double SFTL::get_cached_size(long translation_page_id) const {
+	if (is_compressible(translation_page_id)) {
+		return get_compressed_size(translation_page_id);
+	}
+	return num_mapped_entries[translation_page_id] * MAPPING_ENTRY_SIZE;
+}
+
+// Counts the runs of the translation page just written. Physical pages are numbered across LUNs first,
+// so that a sequential write makes a single run. The block manager sends each page to the LUN with
+// the shortest queue, though, so the pages of a sequential write are shuffled within a few stripes.
+// A run therefore goes on across small steps, each of which is stored in a delta byte.
+void SFTL::register_translation_page_write(long translation_page_id) {
+	vector<int> const& physical_pages = mapping_pages[translation_page_id].physical_pages;
+	total_cached_size -= get_cached_size(translation_page_id);
+	total_mapped_entries -= num_mapped_entries[translation_page_id];
+	num_compressible_pages -= is_compressible(translation_page_id);
+
+	int runs = 0, deltas = 0, entries = 0;
+	long previous = UNDEFINED;
+	for (uint i = 0; i < physical_pages.size(); i++) {
+		if (physical_pages[i] == UNDEFINED) {
+			previous = UNDEFINED;
+			continue;
+		}
+		long striped_page_number = get_striped_page_number(physical_pages[i]);
+		long step = striped_page_number - previous;
+		if (previous == UNDEFINED || abs(step) > MAX_DELTA) {
+			runs++;
+		} else if (step != 1) {
+			deltas++;
+		}
+		previous = striped_page_number;
+		entries++;
+	}
+	num_runs[translation_page_id] = runs;
+	num_deltas[translation_page_id] = deltas;
+	num_mapped_entries[translation_page_id] = entries;
+
+	total_cached_size += get_cached_size(translation_page_id);
+	total_mapped_entries += entries;
+	num_compressible_pages += is_compressible(translation_page_id);
+	if (total_mapped_entries > 0) {
+		set_cache_ram_per_clean_entry(total_cached_size / total_mapped_entries);
+	}
+}
+
+// The entries of a compressible translation page are brought in as prefetched entries,
+// so they are the first to go if they are not read
+void SFTL::register_translation_page_read(long translation_page_id) {
+	if (!is_compressible(translation_page_id)) {
+		return;
+	}
+	num_whole_page_loads++;
+	long first_key_in_translation_page = translation_page_id * ENTRIES_PER_TRANSLATION_PAGE;
+	vector<int> const& physical_pages = mapping_pages[translation_page_id].physical_pages;
+	for (uint i = 0; i < physical_pages.size(); i++) {
+		long lba = first_key_in_translation_page + i;
+		if (physical_pages[i] != UNDEFINED && !cache->contains(lba) && page_mapping->get_physical_address(lba).valid == PAGE) {
+			cache->register_prefetch(lba);
+			num_entries_loaded++;
+		}
+	}
+}
+
+void SFTL::print() const {
+	long num_written_pages = 0;
+	long total_runs = 0, total_deltas = 0;
+	for (uint i = 0; i < num_runs.size(); i++) {
+		num_written_pages += num_mapped_entries[i] > 0;
+		total_runs += num_runs[i];
+		total_deltas += num_deltas[i];
+	}
+	printf("S-FTL:\n");
+	printf("\tcompression threshold:\t%f\n", SFTL_COMPRESSION_THRESHOLD);
+	printf("\ttranslation pages written:\t%ld\n", num_written_pages);
+	printf("\tcompressible translation pages:\t%ld\n", num_compressible_pages);
+	printf("\tentries per run:\t%f\n", total_runs == 0 ? 0 : total_mapped_entries / (double) total_runs);
+	printf("\tentries stored as deltas:\t%f\n", total_mapped_entries == 0 ? 0 : total_deltas / (double) total_mapped_entries);
+	printf("\tRAM for the mapped entries as a page-level map (bytes):\t%ld\n", total_mapped_entries * MAPPING_ENTRY_SIZE);
+	printf("\tRAM for the mapped entries as cached by S-FTL (bytes):\t%f\n", total_cached_size);
+	printf("\tmapping cache RAM (bytes):\t%ld\n", ftl_cache::CACHED_ENTRIES_THRESHOLD * (long) MAPPING_ENTRY_SIZE);
+	printf("\tmapping cache capacity (entries):\t%d\n", cache->get_capacity());
+	printf("\twhole translation page loads:\t%ld\n", num_whole_page_loads);
+	printf("\tentries loaded with whole pages:\t%ld\n", num_entries_loaded);
+}
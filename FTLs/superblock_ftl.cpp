@@ -0,0 +1,143 @@
+/*
+ * superblock_ftl.cpp
+ *
+ * A hybrid FTL that maps groups of logical blocks onto groups of physical blocks, with page mapping inside each group.
+ */
+
+#include <new>
+#include <assert.h>
+#include <stdio.h>
+#include <math.h>
+#include "../ssd.h"
+
+using namespace ssd;
+
+#define BLOCK_ADDRESS_SIZE 4 // bytes taken by a block number in RAM
+
+Superblock_FTL::Superblock_FTL(Ssd *ssd, Block_manager_parent* bm, Migrator* migrator) :
+		Hybrid_FTL(ssd, bm, migrator, SUPERBLOCK_SIZE),
+		superblocks(get_num_groups()),
+		MAX_BLOCKS_PER_SUPERBLOCK(SUPERBLOCK_SIZE + SUPERBLOCK_EXTRA_BLOCKS)
+{
+	// Consecutive superblocks start on different LUNs, so that sequential writes are spread
+	for (uint i = 0; i < superblocks.size(); i++) {
+		superblocks[i].next_lun = (i * SUPERBLOCK_SIZE) % (SSD_SIZE * PACKAGE_SIZE);
+	}
+}
+
+Superblock_FTL::~Superblock_FTL() {
+	print();
+}
+
+// A write goes to any block of the superblock that has a free page and is not being written.
+// If there is none, the superblock opens a block on its next LUN.
+bool Superblock_FTL::choose_write_address(int group_id, Event* write) {
+	superblock& sb = superblocks[group_id];
+	double time = write->get_current_time();
+	bool has_free_pages = false;
+	for (auto& block : sb.blocks) {
+		if (block.page < BLOCK_SIZE) {
+			has_free_pages = true;
+			if (take_page(block, write)) {
+				return true;
+			}
+		}
+	}
+	if ((int) sb.blocks.size() < MAX_BLOCKS_PER_SUPERBLOCK) {
+		Address block = allocate_block(sb.next_lun, false, time);
+		if (block.valid != NONE) {
+			sb.next_lun = (block.package * PACKAGE_SIZE + block.die + 1) % (SSD_SIZE * PACKAGE_SIZE);
+			sb.blocks.push_back(block);
+			return take_page(sb.blocks.back(), write);
+		}
+	}
+	if (has_free_pages) {
+		return false;
+	}
+	if ((int) sb.blocks.size() == MAX_BLOCKS_PER_SUPERBLOCK) {
+		request_merge(group_id, time);
+		return false;
+	}
+
+	// There is no free block left outside the reserve, so the superblock with the most pages to reclaim is merged
+	int victim = UNDEFINED;
+	for (uint i = 0; i < superblocks.size() && may_request_more_merges(); i++) {
+		if (!is_merging(i) && get_num_reclaimable_pages(superblocks[i]) > 0 &&
+				(victim == UNDEFINED || get_num_reclaimable_pages(superblocks[i]) > get_num_reclaimable_pages(superblocks[victim]))) {
+			victim = i;
+		}
+	}
+	if (victim == group_id) {
+		request_merge(group_id, time);
+		return false;
+	}
+	if (victim != UNDEFINED) {
+		request_merge(victim, time);
+	}
+	wait_for_space(group_id);
+	return false;
+}
+
+// The invalid pages of the superblock's full blocks
+int Superblock_FTL::get_num_reclaimable_pages(superblock const& sb) const {
+	int num_reclaimable_pages = 0;
+	for (auto const& a : sb.blocks) {
+		if (a.page == BLOCK_SIZE) {
+			Block* block = ssd->get_package(a.package)->get_die(a.die)->get_plane(a.plane)->get_block(a.block);
+			num_reclaimable_pages += BLOCK_SIZE - block->get_pages_valid();
+		}
+	}
+	return num_reclaimable_pages;
+}
+
+// Reclaims the full block with the fewest live pages. Its live pages are copied into a new block on the next LUN.
+bool Superblock_FTL::merge(int group_id, double time) {
+	superblock& sb = superblocks[group_id];
+	int victim = UNDEFINED;
+	uint fewest_live_pages = BLOCK_SIZE + 1;
+	for (uint i = 0; i < sb.blocks.size(); i++) {
+		Address const& a = sb.blocks[i];
+		Block* block = ssd->get_package(a.package)->get_die(a.die)->get_plane(a.plane)->get_block(a.block);
+		if (a.page == BLOCK_SIZE && block->get_pages_valid() < fewest_live_pages) {
+			victim = i;
+			fewest_live_pages = block->get_pages_valid();
+		}
+	}
+	assert(victim != UNDEFINED);
+
+	vector<long> copies = get_live_logical_addresses(sb.blocks[victim]);
+	Address destination;
+	if (!copies.empty()) {
+		destination = allocate_block(sb.next_lun, true, time);
+		if (destination.valid == NONE) {
+			return false;
+		}
+		sb.next_lun = (destination.package * PACKAGE_SIZE + destination.die + 1) % (SSD_SIZE * PACKAGE_SIZE);
+	}
+	retire_block(sb.blocks[victim], time);
+	sb.blocks.erase(sb.blocks.begin() + victim);
+	migrator->register_merge(copies.empty() ? SWITCH_MERGE : PARTIAL_MERGE, copies.size());
+	copy_pages(group_id, copies, destination, time);
+	return true;
+}
+
+void Superblock_FTL::register_merge_completion(int group_id, Address const& destination, double time) {
+	if (destination.valid != NONE) {
+		superblocks[group_id].blocks.push_back(destination);
+	}
+}
+
+// RAM holds the physical blocks of each superblock, and for each logical page, its page among the superblock's pages
+void Superblock_FTL::print() const {
+	long num_logical_pages = NUMBER_OF_ADDRESSABLE_PAGES() * OVER_PROVISIONING_FACTOR;
+	int page_index_size = ceil(log2(MAX_BLOCKS_PER_SUPERBLOCK * BLOCK_SIZE) / 8);
+	long superblock_map_ram = superblocks.size() * MAX_BLOCKS_PER_SUPERBLOCK * BLOCK_ADDRESS_SIZE;
+	long page_map_ram = num_logical_pages * page_index_size;
+	printf("superblock FTL:\n");
+	printf("\tlogical blocks per superblock:\t%d\n", SUPERBLOCK_SIZE);
+	printf("\tphysical blocks per superblock:\t%d\n", MAX_BLOCKS_PER_SUPERBLOCK);
+	printf("\tsuperblock map RAM (bytes):\t%ld\n", superblock_map_ram);
+	printf("\tpage map RAM (bytes):\t%ld\n", page_map_ram);
+	printf("\tmapping RAM (bytes):\t%ld\n", superblock_map_ram + page_map_ram);
+	print_merge_cost();
+}
@@ -68,7 +68,7 @@ void File_Manager::handle_no_IOs_left() {
 
 void File_Manager::handle_event_completion(Event* event) {
  	if (event->get_event_type() == TRIM) {
-		num_pending_trims--;
+		num_pending_trims -= event->get_size();
 	} else if (event->get_event_type() == WRITE) {
 		//event->print();
 		current_file->register_write_completion(event);
@@ -173,11 +173,8 @@ void File_Manager::schedule_to_trim_file(File* file) {
 	deque<Address_Range> freed_ranges = file->ranges_comprising_file;
 	for (uint i = 0; i < freed_ranges.size(); i++) {
 		Address_Range range = freed_ranges[i];
-		for (int j = range.min; j <= range.max; j++) {
-			//addresses_to_trim.insert(j);
-			Event* trim = new Event(TRIM, j, 1, get_current_time());
-			submit(trim);
-		}
+		Event* trim = new Event(TRIM, range.min, range.get_size(), get_current_time());
+		submit(trim);
 	}
 }
 
@@ -249,7 +249,9 @@ void Grace_Hash_Join::trim_smaller_bucket() {
 	//printf("smaller buck:   %d\n", small_bucket_end - small_bucket_begin);
 	for (int i = small_bucket_begin; i <= small_bucket_end; i++) {
 		reads_in_progress_set.insert(i);
-		Event* event = new Event(TRIM, i, 1, get_current_time());
+	}
+	if (small_bucket_end >= small_bucket_begin) {
+		Event* event = new Event(TRIM, small_bucket_begin, small_bucket_end - small_bucket_begin + 1, get_current_time());
 		submit(event);
 	}
 	finished_trimming_smaller_bucket = true;
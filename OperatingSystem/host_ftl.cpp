@@ -0,0 +1,282 @@
+/*
+ * host_ftl.cpp
+ *
+ * A sample host-side FTL that runs on top of the open-channel interface.
+ * The host chooses the physical address of every read, write and erase,
+ * so the SSD's FTL and block manager are bypassed.
+ */
+
+#include "../ssd.h"
+
+using namespace ssd;
+
+Host_Log_Structured_FTL::Host_Log_Structured_FTL(long min_LBA, long max_LBA, ulong randseed, double write_probability, int MAX_IOS, long num_IOs)
+	: Thread(),
+	  min_LBA(min_LBA),
+	  max_LBA(max_LBA),
+	  write_probability(write_probability),
+	  MAX_IOS(MAX_IOS),
+	  num_IOs_left(num_IOs),
+	  num_host_IOs_in_progress(0),
+	  random_number_generator(randseed),
+	  double_generator(randseed * 13),
+	  next_lba(UNDEFINED),
+	  next_type(WRITE),
+	  next_lun(0),
+	  logical_to_physical(max_LBA - min_LBA + 1, UNDEFINED),
+	  physical_to_logical(NUMBER_OF_ADDRESSABLE_PAGES(), UNDEFINED),
+	  valid_pages_per_block(NUMBER_OF_ADDRESSABLE_BLOCKS(), 0),
+	  invalidations_in_progress_per_block(NUMBER_OF_ADDRESSABLE_BLOCKS(), 0),
+	  luns(SSD_SIZE * PACKAGE_SIZE),
+	  lbas_in_progress(),
+	  ios_in_progress(),
+	  num_host_writes(0), num_host_reads(0), num_gc_writes(0), num_erases(0)
+{
+	assert(MAX_IOS > 0);
+	assert(max_LBA - min_LBA + 1 < NUMBER_OF_ADDRESSABLE_PAGES() - luns.size() * BLOCK_SIZE * 2);
+	uint blocks_per_lun = DIE_SIZE * PLANE_SIZE;
+	for (uint i = 0; i < luns.size(); i++) {
+		for (uint j = 0; j < blocks_per_lun; j++) {
+			luns[i].free_blocks.push_back(i * blocks_per_lun + j);
+		}
+	}
+}
+
+void Host_Log_Structured_FTL::issue_first_IOs() {
+	issue_IOs();
+}
+
+void Host_Log_Structured_FTL::handle_event_completion(Event* event) {
+	pending_io io = ios_in_progress.at(event->get_application_io_id());
+	ios_in_progress.erase(event->get_application_io_id());
+	int lun_id = get_lun_id(event->get_address());
+	lun& l = luns[lun_id];
+
+	if (io.kind == HOST_WRITE || io.kind == GC_WRITE) {
+		l.write_in_progress = false;
+		Address ra = event->get_replace_address();
+		if (ra.valid == PAGE) {
+			invalidations_in_progress_per_block[ra.get_block_id()]--;
+			try_erase_victim(get_lun_id(ra));
+		}
+	}
+	if (io.kind == GC_READ) {
+		l.num_gc_reads_in_progress--;
+		l.migrations_pending.push_back(io.lba);
+	} else if (io.kind == GC_ERASE) {
+		long block_id = event->get_address().get_block_id();
+		l.full_blocks.erase(block_id);
+		l.free_blocks.push_back(block_id);
+		l.victim.valid = NONE;
+		l.erase_in_progress = false;
+		num_erases++;
+		if (should_gc(lun_id)) {
+			start_gc(lun_id);
+		}
+	} else {
+		lbas_in_progress.erase(io.lba);
+	}
+	if (io.kind == HOST_READ || io.kind == HOST_WRITE) {
+		num_host_IOs_in_progress--;
+	}
+	issue_IOs();
+}
+
+void Host_Log_Structured_FTL::handle_no_IOs_left() {
+	if (num_IOs_left == 0) {
+		print_thread_stats();
+	}
+}
+
+// Garbage-collection IOs take precedence over application IOs on every LUN
+void Host_Log_Structured_FTL::issue_IOs() {
+	for (uint i = 0; i < luns.size(); i++) {
+		issue_gc_reads(i);
+		try_issue_migration(i);
+	}
+	while (num_host_IOs_in_progress < MAX_IOS && (num_IOs_left > 0 || next_lba != UNDEFINED) && !is_finished() && !is_stopped()) {
+		if (next_lba == UNDEFINED) {
+			generate_next_host_io();
+		}
+		if (!try_issue_host_io()) {
+			break;
+		}
+	}
+}
+
+void Host_Log_Structured_FTL::generate_next_host_io() {
+	num_IOs_left--;
+	next_lba = min_LBA + random_number_generator() % (max_LBA - min_LBA + 1);
+	next_type = double_generator() <= write_probability ? WRITE : READ;
+}
+
+bool Host_Log_Structured_FTL::try_issue_host_io() {
+	if (lbas_in_progress.count(next_lba) == 1) {
+		return false;
+	}
+	long physical = logical_to_physical[next_lba - min_LBA];
+
+	// Reading an LBA that was never written is pointless, so we write it instead
+	if (next_type == READ && physical != UNDEFINED) {
+		Address addr(physical, PAGE);
+		Event* read = new Open_Channel_Event(READ, addr, get_current_time());
+		ios_in_progress[read->get_application_io_id()] = pending_io(HOST_READ, next_lba);
+		lbas_in_progress.insert(next_lba);
+		num_host_IOs_in_progress++;
+		num_host_reads++;
+		next_lba = UNDEFINED;
+		submit(read);
+		return true;
+	}
+
+	// Stripe writes across LUNs in round robin, skipping LUNs that are busy or out of space
+	for (uint i = 0; i < luns.size(); i++) {
+		int lun_id = (next_lun + i) % luns.size();
+		lun const& l = luns[lun_id];
+		bool has_space = (l.write_pointer.valid == PAGE && l.write_pointer.page < BLOCK_SIZE) || l.free_blocks.size() > 1;
+		if (!l.write_in_progress && l.migrations_pending.empty() && has_space) {
+			next_lun = (lun_id + 1) % luns.size();
+			num_host_IOs_in_progress++;
+			num_host_writes++;
+			lbas_in_progress.insert(next_lba);
+			issue_write(lun_id, next_lba, HOST_WRITE);
+			next_lba = UNDEFINED;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool Host_Log_Structured_FTL::try_issue_migration(int lun_id) {
+	lun& l = luns[lun_id];
+	if (l.write_in_progress || l.migrations_pending.empty()) {
+		return false;
+	}
+	long lba = l.migrations_pending.front();
+	l.migrations_pending.pop_front();
+	num_gc_writes++;
+	issue_write(lun_id, lba, GC_WRITE);
+	return true;
+}
+
+// Live pages are read one LBA at a time, so that the host never reads and overwrites the same LBA concurrently
+void Host_Log_Structured_FTL::issue_gc_reads(int lun_id) {
+	lun& l = luns[lun_id];
+	deque<long> still_pending;
+	while (!l.gc_reads_pending.empty()) {
+		long physical = l.gc_reads_pending.front();
+		l.gc_reads_pending.pop_front();
+		long lba = physical_to_logical[physical];
+		if (lba == UNDEFINED) {
+			continue;
+		}
+		if (lbas_in_progress.count(lba) == 1) {
+			still_pending.push_back(physical);
+			continue;
+		}
+		Address addr(physical, PAGE);
+		Event* read = new Open_Channel_Event(READ, addr, get_current_time());
+		ios_in_progress[read->get_application_io_id()] = pending_io(GC_READ, lba);
+		lbas_in_progress.insert(lba);
+		l.num_gc_reads_in_progress++;
+		submit(read);
+	}
+	l.gc_reads_pending = still_pending;
+	try_erase_victim(lun_id);
+}
+
+// Host writes leave one free block per LUN in reserve, so that garbage collection can always make progress
+Address Host_Log_Structured_FTL::allocate_page(int lun_id, bool is_gc) {
+	lun& l = luns[lun_id];
+	if (l.write_pointer.valid == NONE || l.write_pointer.page == BLOCK_SIZE) {
+		if (l.write_pointer.valid == PAGE) {
+			l.full_blocks.insert(l.write_pointer.get_block_id());
+		}
+		assert(l.free_blocks.size() > (is_gc ? 0 : 1));
+		long block_id = l.free_blocks.front();
+		l.free_blocks.pop_front();
+		l.write_pointer = Address(block_id * BLOCK_SIZE, PAGE);
+		if (should_gc(lun_id)) {
+			start_gc(lun_id);
+		}
+	}
+	Address page = l.write_pointer;
+	l.write_pointer.page++;
+	return page;
+}
+
+void Host_Log_Structured_FTL::issue_write(int lun_id, long lba, io_kind kind) {
+	Address addr = allocate_page(lun_id, kind == GC_WRITE);
+	Event* write = new Open_Channel_Event(WRITE, addr, get_current_time());
+	long old_physical = logical_to_physical[lba - min_LBA];
+	if (old_physical != UNDEFINED) {
+		Address ra(old_physical, PAGE);
+		write->set_replace_address(ra);
+		physical_to_logical[old_physical] = UNDEFINED;
+		valid_pages_per_block[ra.get_block_id()]--;
+		invalidations_in_progress_per_block[ra.get_block_id()]++;
+	}
+	long physical = addr.get_linear_address();
+	logical_to_physical[lba - min_LBA] = physical;
+	physical_to_logical[physical] = lba;
+	valid_pages_per_block[addr.get_block_id()]++;
+	luns[lun_id].write_in_progress = true;
+	ios_in_progress[write->get_application_io_id()] = pending_io(kind, lba);
+	submit(write);
+}
+
+bool Host_Log_Structured_FTL::should_gc(int lun_id) const {
+	return luns[lun_id].free_blocks.size() < max(GREED_SCALE, 2);
+}
+
+// Greedy victim selection among the full blocks of the LUN
+void Host_Log_Structured_FTL::start_gc(int lun_id) {
+	lun& l = luns[lun_id];
+	if (l.victim.valid != NONE || l.full_blocks.empty()) {
+		return;
+	}
+	long victim = UNDEFINED;
+	for (auto block_id : l.full_blocks) {
+		if (victim == UNDEFINED || valid_pages_per_block[block_id] < valid_pages_per_block[victim]) {
+			victim = block_id;
+		}
+	}
+	l.victim = Address(victim * BLOCK_SIZE, BLOCK);
+	for (uint i = 0; i < BLOCK_SIZE; i++) {
+		long physical = victim * BLOCK_SIZE + i;
+		if (physical_to_logical[physical] != UNDEFINED) {
+			l.gc_reads_pending.push_back(physical);
+		}
+	}
+	issue_gc_reads(lun_id);
+}
+
+// The victim can only be erased once no in-flight IO still refers to any of its pages
+void Host_Log_Structured_FTL::try_erase_victim(int lun_id) {
+	lun& l = luns[lun_id];
+	if (l.victim.valid == NONE || l.erase_in_progress || l.num_gc_reads_in_progress > 0 || !l.gc_reads_pending.empty()) {
+		return;
+	}
+	long block_id = l.victim.get_block_id();
+	if (valid_pages_per_block[block_id] > 0 || invalidations_in_progress_per_block[block_id] > 0) {
+		return;
+	}
+	Event* erase = new Open_Channel_Event(ERASE, l.victim, get_current_time());
+	ios_in_progress[erase->get_application_io_id()] = pending_io(GC_ERASE, UNDEFINED);
+	l.erase_in_progress = true;
+	submit(erase);
+}
+
+int Host_Log_Structured_FTL::get_lun_id(Address const& addr) const {
+	return addr.package * PACKAGE_SIZE + addr.die;
+}
+
+void Host_Log_Structured_FTL::print_thread_stats() {
+	printf("host log-structured FTL\n");
+	printf("\thost writes:\t%ld\n", num_host_writes);
+	printf("\thost reads:\t%ld\n", num_host_reads);
+	printf("\tgc writes:\t%ld\n", num_gc_writes);
+	printf("\terases:\t%ld\n", num_erases);
+	double write_amp = num_host_writes == 0 ? 0 : (num_host_writes + num_gc_writes) / (double)num_host_writes;
+	printf("\twrite amplification:\t%f\n", write_amp);
+}
@@ -145,6 +145,7 @@ void OperatingSystem::dispatch_event(int thread_id) {
 
 	currently_executing_ios.insert(event->get_application_io_id());
 	app_id_to_thread_id_mapping[event->get_application_io_id()] = thread_id;
+	event->set_thread_id(thread_id);
 
 	//printf("dispatching:\t"); event->print();
 
@@ -17,7 +17,8 @@ bool Thread::record_internal_statistics = false;
 Thread::Thread() :
 		finished(false), time(1), threads_to_start_when_this_thread_finishes(),
 		os(NULL), internal_statistics_gatherer(new StatisticsGatherer()),
-		external_statistics_gatherer(NULL), num_IOs_executing(0), io_queue(), stopped(false) {}
+		external_statistics_gatherer(NULL), num_IOs_executing(0), io_queue(), stopped(false), stream_id(UNDEFINED),
+		min_compression_ratio(UNDEFINED), max_compression_ratio(UNDEFINED), compression_generator(7411) {}
 
 Thread::~Thread() {
 	for (auto t : threads_to_start_when_this_thread_finishes) {
@@ -98,6 +99,12 @@ void Thread::submit(Event* event) {
 		return;
 	}
 	event->set_start_time(event->get_current_time());
+	if (event->get_stream_id() == UNDEFINED) {
+		event->set_stream_id(stream_id);
+	}
+	if (event->get_event_type() == WRITE && event->get_compression_ratio() == UNDEFINED && min_compression_ratio != UNDEFINED) {
+		event->set_compression_ratio(min_compression_ratio + (max_compression_ratio - min_compression_ratio) * compression_generator());
+	}
 	io_queue.push(event);
 	num_IOs_executing++;
 	if (!can_submit_more()) {
@@ -106,6 +113,12 @@ void Thread::submit(Event* event) {
 	}
 }
 
+void Thread::set_compressibility(double min_ratio, double max_ratio) {
+	assert(min_ratio > 0 && min_ratio <= max_ratio);
+	min_compression_ratio = min_ratio;
+	max_compression_ratio = max_ratio;
+}
+
 void Thread::set_statistics_gatherer(StatisticsGatherer* new_statistics_gatherer) {
 	external_statistics_gatherer = new_statistics_gatherer;
 }
@@ -118,7 +131,8 @@ Simple_Thread::Simple_Thread(IO_Pattern* generator, IO_Mode_Generator* mode_gen,
 	  io_gen(generator),
 	  io_type_gen(mode_gen),
 	  number_of_times_to_repeat(num_IOs),
-	  io_size(1)
+	  io_size(1),
+	  write_stream(UNDEFINED)
 {
 	assert(MAX_IOS > 0);
 }
@@ -128,7 +142,8 @@ Simple_Thread::Simple_Thread(IO_Pattern* generator, int MAX_IOS, IO_Mode_Generat
 	  MAX_IOS(MAX_IOS),
 	  io_gen(generator),
 	  io_type_gen(mode_gen),
-	  io_size(1)
+	  io_size(1),
+	  write_stream(UNDEFINED)
 {
 	assert(MAX_IOS > 0);
 	number_of_times_to_repeat = generator->max_LBA - generator->min_LBA + 1;
@@ -145,6 +160,9 @@ void Simple_Thread::generate_io() {
 		event_type type = io_type_gen->next();
 		long logical_addr = io_gen->next();
 		Event* e = new Event(type, logical_addr, io_size, get_current_time());
+		if (type == WRITE) {
+			e->set_stream_id(write_stream);
+		}
 		submit(e);
 	}
 
@@ -40,6 +40,12 @@ public:
 	StatisticsGatherer* get_external_statistics_gatherer() { return external_statistics_gatherer; }
 	void set_statistics_gatherer(StatisticsGatherer* new_statistics_gatherer);
 	void set_finished() { finished = true; }
+	// Declares the write stream of all IOs this thread submits, unless an IO already has a stream of its own
+	inline void set_stream(int new_stream_id) { stream_id = new_stream_id; }
+	inline int get_stream() const { return stream_id; }
+	// Declares how well the data written by this thread compresses. Each write gets a compression ratio,
+	// as a fraction of a page, drawn uniformly between the two bounds.
+	void set_compressibility(double min_ratio, double max_ratio);
     friend class boost::serialization::access;
     template<class Archive>
     void serialize(Archive & ar, const unsigned int version) {
@@ -64,6 +70,9 @@ private:
 	queue<Event*> io_queue;
 	bool finished;
 	bool stopped;
+	int stream_id;
+	double min_compression_ratio, max_compression_ratio;
+	MTRand_open compression_generator;
 	static bool record_internal_statistics;
 };
 
@@ -240,7 +249,7 @@ private:
 class Simple_Thread : public Thread
 {
 public:
-	Simple_Thread() : io_gen(NULL), io_type_gen(NULL), number_of_times_to_repeat(0), MAX_IOS(0), io_size(1) {}
+	Simple_Thread() : io_gen(NULL), io_type_gen(NULL), number_of_times_to_repeat(0), MAX_IOS(0), io_size(1), write_stream(UNDEFINED) {}
 	Simple_Thread(IO_Pattern* generator, int MAX_IOS, IO_Mode_Generator* type);
 	Simple_Thread(IO_Pattern* generator, IO_Mode_Generator* type, int MAX_IOS, long num_IOs);
 	virtual ~Simple_Thread();
@@ -249,6 +258,7 @@ public:
 	void handle_event_completion(Event* event);
 	void set_io_size(int size) { io_size = size; }
 	inline void set_num_ios(ulong num_ios) { number_of_times_to_repeat = num_ios; }
+	inline void set_write_stream(int stream_id) { write_stream = stream_id; }
     friend class boost::serialization::access;
     template<class Archive>
     void serialize(Archive & ar, const unsigned int version) {
@@ -265,6 +275,7 @@ private:
 	IO_Pattern* io_gen;
 	IO_Mode_Generator* io_type_gen;
 	int io_size; // in pages
+	int write_stream; // the stream given to writes only. Reads and trims get the thread's stream, if any
 };
 
 
@@ -629,6 +640,73 @@ private:
 	Flexible_Reader* flex_reader;
 };
 
+// A sample host-side FTL for open-channel mode. It issues random reads and writes on its logical address space,
+// keeps its own page mapping, appends writes to an open block on each LUN and garbage-collects greedily,
+// all by means of physical IOs that bypass the SSD's FTL and block manager.
+class Host_Log_Structured_FTL : public Thread
+{
+public:
+	Host_Log_Structured_FTL(long min_LBA, long max_LBA, ulong randseed, double write_probability = 1.0, int MAX_IOS = MAX_SSD_QUEUE_SIZE * 2, long num_IOs = INFINITE);
+	void issue_first_IOs();
+	void handle_event_completion(Event* event);
+	void handle_no_IOs_left();
+	void print_thread_stats();
+private:
+	enum io_kind {HOST_READ, HOST_WRITE, GC_READ, GC_WRITE, GC_ERASE};
+	struct pending_io {
+		pending_io() : kind(HOST_READ), lba(UNDEFINED) {}
+		pending_io(io_kind kind, long lba) : kind(kind), lba(lba) {}
+		io_kind kind;
+		long lba;
+	};
+	struct lun {
+		lun() : free_blocks(), full_blocks(), write_pointer(), victim(), gc_reads_pending(), migrations_pending(), write_in_progress(false), erase_in_progress(false), num_gc_reads_in_progress(0) {}
+		deque<long> free_blocks;
+		set<long> full_blocks;
+		Address write_pointer;			// valid == NONE when there is no open block
+		Address victim;					// valid == NONE when no block is being garbage-collected
+		deque<long> gc_reads_pending;	// live pages in the victim that still need to be read
+		deque<long> migrations_pending;	// LBAs read from the victim, waiting to be rewritten
+		bool write_in_progress;			// pages within a block must be programmed in order, so we allow one write per LUN at a time
+		bool erase_in_progress;
+		int num_gc_reads_in_progress;
+	};
+
+	void issue_IOs();
+	void generate_next_host_io();
+	bool try_issue_host_io();
+	bool try_issue_migration(int lun_id);
+	void issue_gc_reads(int lun_id);
+	Address allocate_page(int lun_id, bool is_gc);
+	void issue_write(int lun_id, long lba, io_kind kind);
+	bool should_gc(int lun_id) const;
+	void start_gc(int lun_id);
+	void try_erase_victim(int lun_id);
+	int get_lun_id(Address const& addr) const;
+
+	long min_LBA, max_LBA;
+	double write_probability;
+	int MAX_IOS;
+	long num_IOs_left;
+	int num_host_IOs_in_progress;
+	MTRand_int32 random_number_generator;
+	MTRand_open double_generator;
+
+	long next_lba;
+	event_type next_type;
+	int next_lun;
+
+	vector<long> logical_to_physical;
+	vector<long> physical_to_logical;
+	vector<int> valid_pages_per_block;
+	vector<int> invalidations_in_progress_per_block;
+	vector<lun> luns;
+	set<long> lbas_in_progress;
+	unordered_map<uint, pending_io> ios_in_progress;
+
+	long num_host_writes, num_host_reads, num_gc_writes, num_erases;
+};
+
 // This class can be extended to allow customized IO scheduling policies
 class OS_Scheduler {
 public:
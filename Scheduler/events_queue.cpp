@@ -56,6 +56,19 @@ Event* event_queue::find(long dependency_code) const {
 	return NULL;
 }
 
+// A write that has not been given an address yet may go to any LUN
+bool event_queue::is_application_io_waiting_on(Address const& lun, bool count_unplaced_writes) const {
+	for (auto const& entry : events) {
+		for (auto const& e : entry.second) {
+			Address const& a = e->get_address();
+			if (e->is_original_application_io() && ((a.valid == NONE && count_unplaced_writes) || (a.package == lun.package && a.die == lun.die))) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
 bool event_queue::remove(Event* event) {
 	num_events--;
 	if (event == NULL) return false;
@@ -165,6 +165,10 @@ bool IOScheduler::is_empty() {
 	return current_events->empty() && future_events->empty() && overdue_events->empty();
 }
 
+bool IOScheduler::is_application_io_waiting_on(Address const& lun, bool count_unplaced_writes) const {
+	return current_events->is_application_io_waiting_on(lun, count_unplaced_writes) || overdue_events->is_application_io_waiting_on(lun, count_unplaced_writes);
+}
+
 double IOScheduler::get_soonest_event_time(vector<Event*> const& events) const {
 	double earliest_time = events.front()->get_current_time();
 	for (uint i = 1; i < events.size(); i++) {
@@ -282,6 +286,13 @@ void IOScheduler::handle_read(Event* event) {
 		i++;
 	}
 
+	// Each page migration of a GC operation starts with its read command, where GC may give way to host IOs
+	if (event->is_garbage_collection_op() && migrator->should_pause_gc(*event)) {
+		event->incr_bus_wait_time(BUS_DATA_DELAY + BUS_CTRL_DELAY);
+		push(event);
+		return;
+	}
+
 	double time = bm->in_how_long_can_this_event_be_scheduled(event->get_address(), event->get_current_time());
 	bool can_schedule = bm->can_schedule_on_die(event->get_address(), event->get_event_type(), event->get_application_io_id());
 
@@ -397,7 +408,8 @@ void IOScheduler::handle_write(Event* event) {
 	else if (!bm->can_schedule_on_die(addr, event->get_event_type(), event->get_application_io_id())) {
 		event->incr_bus_wait_time(wait_time + BUS_DATA_DELAY + BUS_CTRL_DELAY);
 		push(event);
-		assert(false);
+		// The block manager never chooses a die whose register is busy, but a host-side FTL or a block-mapped FTL might
+		assert(event->is_open_channel_op() || !IS_FTL_PAGE_MAPPING);
 	}
 	else if (wait_time > 0) {
 		event->incr_bus_wait_time(wait_time);
@@ -406,7 +418,9 @@ void IOScheduler::handle_write(Event* event) {
 	else {
 		event->set_address(addr);
 		//if (event->get_replace_address().valid == NONE) {
+		if (!event->is_open_channel_op()) {
 			ftl->set_replace_address(*event);
+		}
 		//}
 		assert(addr.page < BLOCK_SIZE);
 		execute_next(event);
@@ -435,10 +449,10 @@ void IOScheduler::remove_current_operation(Event* event) {
 	event->set_noop(true);
 	if (event->get_event_type() == READ_TRANSFER) {
 		ssd->get_package(event->get_address().package)->get_die(event->get_address().die)->clear_register();
-		bm->register_register_cleared();
+		bm->update_LUN_availability(event->get_address());
 	} else if (event->get_event_type() == COPY_BACK) {
 		ssd->get_package(event->get_replace_address().package)->get_die(event->get_replace_address().die)->clear_register();
-		bm->register_register_cleared();
+		bm->update_LUN_availability(event->get_replace_address());
 	}
 }
 
@@ -477,6 +491,9 @@ void IOScheduler::handle_noop_events(vector<Event*>& events) {
 void IOScheduler::inform_FTL_of_noop_completion(Event* event) {
 	//static int c = 0;
 	//printf("%d\n", c++);
+	if (event->is_open_channel_op()) {
+		return;
+	}
 	if (event->get_event_type() == READ_TRANSFER) {
 		ftl->register_read_completion(*event, SUCCESS);
 		if (event->is_garbage_collection_op()) {
@@ -532,6 +549,7 @@ void IOScheduler::setup_dependent_event(Event* event, Event* dependent) {
 enum status IOScheduler::execute_next(Event* event) {
 	enum status result = ssd->issue(event);
 	assert(result == SUCCESS);
+	bm->update_LUN_availability(event->get_address());
 
 	if (PRINT_LEVEL > 0  /*&& event->is_original_application_io() */ /*&& (event->get_event_type() == WRITE || event->get_event_type() == ERASE *//*|| event->get_event_type() == READ_TRANSFER)*/   /* && event->is_garbage_collection_op() && (event->get_event_type() == WRITE || event->get_event_type() == ERASE)*/ ) {
 		event->print();
@@ -671,6 +689,10 @@ void IOScheduler::handle_finished_event(Event *event) {
 
 	current_events->register_event_compeltion(event);
 	overdue_events->register_event_compeltion(event);
+	if (event->is_open_channel_op()) {
+		handle_finished_open_channel_event(event);
+		return;
+	}
 	if (event->get_event_type() == WRITE || event->get_event_type() == COPY_BACK) {
 		ftl->register_write_completion(*event, SUCCESS);
 		bm->register_write_outcome(*event, SUCCESS);
@@ -693,6 +715,36 @@ void IOScheduler::handle_finished_event(Event *event) {
 	migrator->register_event_completion(event);
 }
 
+// The host-side FTL keeps its own mapping and block state, so the only thing the SSD
+// does when a physical write completes is to invalidate the page the host says it replaces.
+void IOScheduler::handle_finished_open_channel_event(Event* event) {
+	Address ra = event->get_replace_address();
+	if (event->get_event_type() == WRITE && ra.valid == PAGE) {
+		Block* block = ssd->get_package(ra.package)->get_die(ra.die)->get_plane(ra.plane)->get_block(ra.block);
+		if (block->get_page(ra.page).get_state() == VALID) {
+			block->invalidate_page(ra.page);
+		}
+	}
+}
+
+// Open-channel IOs already carry their physical address, so neither the FTL nor the block manager is consulted.
+void IOScheduler::init_open_channel_event(Event* event) {
+	event_type type = event->get_event_type();
+	if (type == READ) {
+		event->set_event_type(READ_COMMAND);
+		Event* read_transfer = new Event(*event);
+		read_transfer->set_event_type(READ_TRANSFER);
+		read_transfer->set_address(event->get_address());
+		dependencies[event->get_application_io_id()].push_front(read_transfer);
+	}
+	if (type == ERASE || should_event_be_scheduled(event)) {
+		push(event);
+	} else if (PRINT_LEVEL >= 1) {
+		printf("Event not scheduled: ");
+		event->print();
+	}
+}
+
 void IOScheduler::init_event(Event* event) {
 	uint dep_code = event->get_application_io_id();
 	event_type type = event->get_event_type();
@@ -702,6 +754,16 @@ void IOScheduler::init_event(Event* event) {
 		return;
 	}
 
+	if (event->is_open_channel_op()) {
+		init_open_channel_event(event);
+		return;
+	}
+
+	if (type == TRIM && event->get_size() > 1 && ftl->is_range_trim_supported()) {
+		init_range_trim(event);
+		return;
+	}
+
 	if (event->is_flexible_read() && (type == READ_COMMAND || type == READ_TRANSFER)) {
 		push(event);
 	}
@@ -760,6 +822,29 @@ void IOScheduler::init_event(Event* event) {
 }
 
 
+// A range trim is split once it is dispatched. A logical address that another IO is working on gets a trim of its own,
+// which the rules in remove_redundant_events order with that IO. The rest of the range is unmapped and invalidated
+// in bulk, and the range trim completes as a noop.
+void IOScheduler::init_range_trim(Event* event) {
+	double time = event->get_current_time();
+	long first_logical_address = event->get_logical_address();
+	vector<Address> invalidated_pages;
+	for (long la = first_logical_address; la < first_logical_address + event->get_size(); la++) {
+		if (LBA_currently_executing.count(la) == 1) {
+			schedule_event(new Event(TRIM, la, 1, time));
+			continue;
+		}
+		Address ra = ftl->unmap(la);
+		if (ra.valid == PAGE) {
+			invalidated_pages.push_back(ra);
+		}
+	}
+	migrator->invalidate_pages(invalidated_pages, *event);
+	bm->trim(*event);
+	event->set_noop(true);
+	push(event);
+}
+
 void IOScheduler::trigger_next_migration(Event* event) {
 	if (!migrator->more_migrations(event)) {
 		return;
@@ -793,7 +878,7 @@ void IOScheduler::trigger_next_migration(Event* event) {
 }
 
 void IOScheduler::try_to_put_in_safe_cache(Event* write) {
-	if (safe_cache.has_space() && !safe_cache.exists(write->get_logical_address()) && !write->is_garbage_collection_op() && write->is_original_application_io()) {
+	if (safe_cache.has_space() && !safe_cache.exists(write->get_logical_address()) && !write->is_garbage_collection_op() && write->is_original_application_io() && !write->is_open_channel_op()) {
 		safe_cache.insert(write->get_logical_address());
 		Event* immediate_response = new Event(*write);
 		//immediate_response->print();
@@ -34,3 +34,7 @@ vector<int> Random_Order_Iterator::get_iterator(int needed_length) {
 	shuffle(order);
 	return order;
 }
+
+int Random_Order_Iterator::get_random_index(int needed_length) {
+	return random_number_generator() % needed_length;
+}
@@ -49,6 +49,9 @@ StatisticsGatherer::StatisticsGatherer()
 	  num_gc_targeting_anything(0),
 	  num_wl_writes_per_LUN_origin(SSD_SIZE, vector<uint>(PACKAGE_SIZE, 0)),
 	  num_wl_writes_per_LUN_destination(SSD_SIZE, vector<uint>(PACKAGE_SIZE, 0)),
+	  num_app_writes_per_stream(),
+	  num_gc_writes_per_stream(),
+	  sum_gc_wait_time_per_stream(),
 	  end_time(0)
 {}
 
@@ -143,6 +146,15 @@ void StatisticsGatherer::register_completed_event(Event const& event) {
 		num_copy_backs_per_LUN[a.package][a.die]++;
 	}
 
+	if (event.get_event_type() == WRITE && event.get_stream_id() != UNDEFINED) {
+		if (event.is_original_application_io()) {
+			num_app_writes_per_stream[event.get_stream_id()]++;
+		} else if (event.is_garbage_collection_op()) {
+			num_gc_writes_per_stream[event.get_stream_id()]++;
+			sum_gc_wait_time_per_stream[event.get_stream_id()] += event.get_latency();
+		}
+	}
+
 	double bucket = ceil(max(0.0, event.get_latency() - wait_time_histogram_bin_size / 2) / wait_time_histogram_bin_size)*wait_time_histogram_bin_size;
 	if      (event.is_original_application_io() && event.get_event_type() == WRITE) { wait_time_histogram_appIOs_write[bucket]++; wait_time_histogram_appIOs_write_and_read[bucket]++; }
 	else if (event.is_original_application_io() && event.get_event_type() == READ_TRANSFER)  { wait_time_histogram_appIOs_read[bucket]++; wait_time_histogram_appIOs_write_and_read[bucket]++; }
@@ -236,6 +248,15 @@ double get_max(vector<T> const& vector)
     return max;
 }
 
+template <class T>
+double get_percentile(vector<T> vector, double percentile)
+{
+	if (vector.size() == 0) return 0;
+	uint index = min((uint) (vector.size() * percentile), (uint) vector.size() - 1);
+	nth_element(vector.begin(), vector.begin() + index, vector.end());
+	return vector[index];
+}
+
 template <class T>
 double get_sum(vector<T> const& vector)
 {
@@ -443,6 +464,45 @@ void StatisticsGatherer::print_mapping_info() {
 
 	printf("%d\t\t", (int) get_sum(num_mapping_writes_per_LUN));
 	printf("%d\t\t", (int) all_mapping_reads);
+	printf("\n");
+
+	double num_app_writes = get_sum(num_writes_per_LUN);
+	printf("map writes per app write:\t%f\n\n", num_app_writes == 0 ? 0 : get_sum(num_mapping_writes_per_LUN) / num_app_writes);
+}
+
+// Write amplification per stream is (app writes + GC writes) / app writes, where GC writes are
+// attributed to the stream the migrated page was last written in
+void StatisticsGatherer::print_stream_info() {
+	if (num_app_writes_per_stream.empty()) {
+		return;
+	}
+
+	printf("\nstream\t");
+	printf("app writes\t");
+	printf("GC writes\t");
+	printf("write amp\t");
+	printf("GC wait\t");
+	printf("\n");
+
+	long total_app_writes = 0, total_gc_writes = 0;
+	for (auto s : num_app_writes_per_stream) {
+		long app_writes = s.second;
+		long gc_writes = num_gc_writes_per_stream.count(s.first) == 1 ? num_gc_writes_per_stream.at(s.first) : 0;
+		double gc_wait = gc_writes == 0 ? 0 : sum_gc_wait_time_per_stream.at(s.first) / gc_writes;
+		printf("%d\t", s.first);
+		printf("%ld\t\t", app_writes);
+		printf("%ld\t\t", gc_writes);
+		printf("%f\t", (app_writes + gc_writes) / (double)app_writes);
+		printf("%f\t", gc_wait);
+		printf("\n");
+		total_app_writes += app_writes;
+		total_gc_writes += gc_writes;
+	}
+
+	printf("\nTotals:\t");
+	printf("%ld\t\t", total_app_writes);
+	printf("%ld\t\t", total_gc_writes);
+	printf("%f\t", (total_app_writes + total_gc_writes) / (double)total_app_writes);
 	printf("\n\n");
 }
 
@@ -453,10 +513,12 @@ void StatisticsGatherer::print_simple(FILE* stream) {
 	double write_avg = get_average(all_write_latency);
 	double write_std = get_std(all_write_latency);
 	double write_max = get_max(all_write_latency);
+	double write_p99 = get_percentile(all_write_latency, 0.99);
 
 	fprintf(stream, "num writes:\t%d\n", total_writes());
 	fprintf(stream, "avg writes latency:\t%f\n", write_avg);
 	fprintf(stream, "std writes latency:\t%f\n", write_std);
+	fprintf(stream, "99th percentile writes latency:\t%f\n", write_p99);
 	fprintf(stream, "max writes latency:\t%f\n\n", write_max);
 
 	vector<double> all_reads_latency;
@@ -464,10 +526,12 @@ void StatisticsGatherer::print_simple(FILE* stream) {
 	double reads_avg = get_average(all_reads_latency);
 	double reads_std = get_std(all_reads_latency);
 	double reads_max = get_max(all_reads_latency);
+	double reads_p99 = get_percentile(all_reads_latency, 0.99);
 
 	fprintf(stream, "num reads:\t%d\n", total_reads());
 	fprintf(stream, "avg reads latency:\t%f\n", reads_avg);
 	fprintf(stream, "std reads latency:\t%f\n", reads_std);
+	fprintf(stream, "99th percentile reads latency:\t%f\n", reads_p99);
 	fprintf(stream, "max reads latency:\t%f\n\n", reads_max);
 
 	fprintf(stream, "num gc reads:\t%d\n", (int)get_sum(num_gc_reads_per_LUN));
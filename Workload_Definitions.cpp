@@ -95,6 +95,21 @@ vector<Thread*> Asynch_Random_Workload::generate() {
 	return threads;
 }
 
+//*****************************************************************************************
+//				Open-channel RANDOM WORKLOAD
+//*****************************************************************************************
+
+Open_Channel_Random_Workload::Open_Channel_Random_Workload(double writes_probability)
+	: writes_probability(writes_probability) {}
+
+vector<Thread*> Open_Channel_Random_Workload::generate() {
+	Thread* thread = new Host_Log_Structured_FTL(min_lba, max_lba, 2521, writes_probability);
+	Individual_Threads_Statistics::init();
+	Individual_Threads_Statistics::register_thread(thread, "Host Log-Structured FTL");
+	vector<Thread*> threads(1, thread);
+	return threads;
+}
+
 //*****************************************************************************************
 //				Classical INIT workload
 //*****************************************************************************************
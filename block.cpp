@@ -11,7 +11,8 @@ Block::Block(long physical_address):
 			physical_address(physical_address),
 			data(BLOCK_SIZE, Page()),
 			pages_valid(0),
-			erases_remaining(BLOCK_ERASES)
+			erases_remaining(BLOCK_ERASES),
+			slc_mode(false)
 {}
 
 Block::Block():
@@ -19,7 +20,8 @@ Block::Block():
 			physical_address(0),
 			data(BLOCK_SIZE, Page()),
 			pages_valid(0),
-			erases_remaining(BLOCK_ERASES)
+			erases_remaining(BLOCK_ERASES),
+			slc_mode(false)
 {}
 
 enum status Block::read(Event &event)
@@ -34,8 +36,17 @@ enum status Block::write(Event &event)
 		event.print();
 		assert(data[event.get_address().page - 1].get_state() != EMPTY);
 	}
-	enum status ret = data[event.get_address().page]._write(event);
+	double write_delay = slc_mode ? PAGE_WRITE_DELAY * SLC_PAGE_WRITE_DELAY_FACTOR : PAGE_WRITE_DELAY;
+	enum status ret = data[event.get_address().page]._write(event, write_delay);
 	pages_valid++;
+
+	// The pages an SLC-mode block cannot hold count as invalid, so that the block is full once its capacity is written
+	if (slc_mode && event.get_address().page == get_capacity() - 1) {
+		for (uint i = get_capacity(); i < BLOCK_SIZE; i++) {
+			data[i].set_state(INVALID);
+			pages_invalid++;
+		}
+	}
 	return ret;
 }
 
@@ -62,9 +73,25 @@ enum status Block::_erase(Event &event)
 	erases_remaining--;
 	pages_valid = 0;
 	pages_invalid = 0;
+	slc_mode = false;
 	return SUCCESS;
 }
 
+// A block-mapped FTL may retire a block before all of its pages are written. The pages left empty
+// count as invalid, so that the block can be erased once its live pages are gone.
+uint Block::invalidate_empty_pages()
+{
+	uint num_empty_pages = 0;
+	for (uint i = 0; i < BLOCK_SIZE; i++) {
+		if (data[i].get_state() == EMPTY) {
+			data[i].set_state(INVALID);
+			num_empty_pages++;
+		}
+	}
+	pages_invalid += num_empty_pages;
+	return num_empty_pages;
+}
+
 void Block::invalidate_page(uint page)
 {
 	assert(page < BLOCK_SIZE);
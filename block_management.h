@@ -19,7 +19,10 @@ public:
 	//Migrator(Migrator&);
 	~Migrator();
 	void init(IOScheduler*, Block_manager_parent*, Garbage_Collector*, Wear_Leveling_Strategy*, FtlParent*, Ssd*);
-	void schedule_gc(double time, int package, int die, int block, int klass);
+	void schedule_gc(double time, int package, int die, int block, int klass, bool background = false, bool wear_leveling = false);
+	void schedule_background_gc(double time);
+	void schedule_background_gc(double time, int package, int die);
+	bool should_pause_gc(Event const& gc_read);
 	vector<deque<Event*> > migrate(Event * gc_event);
 	void update_structures(Address const& a, double time);
 	void print_pending_migrations();
@@ -28,8 +31,16 @@ public:
 	void register_event_completion(Event* event);
 	void register_ECC_check_on(uint logical_address);
 	uint how_many_gc_operations_are_scheduled() const;
+	bool is_being_garbage_collected(Address const& block) const;
 	void set_block_manager(Block_manager_parent* b) { bm = b; }
 	Garbage_Collector* get_garbage_collector() { return gc; }
+	void invalidate_pages(vector<Address>& pages, Event const& trim);
+	void register_merge(enum merge_type type, int num_page_copies);
+	long get_num_merges() const;
+	long get_num_merge_page_copies() const;
+	void print_merges() const;
+	void print_background_gc() const;
+	void print_gc_pauses() const;
     friend class boost::serialization::access;
     template<class Archive>
     void serialize(Archive & ar, const unsigned int version)
@@ -47,6 +58,8 @@ private:
 	void handle_erase_completion(Event* event);
 	void handle_trim_completion(Event* event);
 	void issue_erase(Address ra, double time);
+	double get_gc_latency_budget(int package, int die) const;
+	int get_num_pages_left_to_migrate(int package, int die) const;
 	IOScheduler *scheduler;
 	Block_manager_parent* bm;
 	Ssd* ssd;
@@ -60,6 +73,69 @@ private:
 	vector<int> num_erases_scheduled_per_package;
 	unordered_map<long, vector<deque<Event*> > > dependent_gc;
 	unordered_map<Block*, double> gc_time_stat;
+	vector<long> num_merges;		// per merge type, for hybrid FTLs
+	vector<long> num_merge_page_copies;
+	long num_background_gcs;		// blocks garbage-collected while the host left the SSD idle
+	long num_background_gcs_yielded;	// background GC operations dropped because host IO had arrived
+	long num_victim_selections;
+	double victim_selection_cpu_time;	// seconds the garbage collector spent choosing victims
+	vector<vector<double> > gc_paused_since;	// per LUN, when GC last gave way to host IOs, or UNDEFINED if it is running
+	long num_gc_pauses;
+	long num_gc_pauses_cut_short;	// pauses that ended while host IOs were still waiting, because the budget ran out
+	double gc_pause_time;
+	long num_concurrent_gcs;		// victims taken while their LUN was already garbage-collecting another block
+	uint max_concurrent_gcs_per_LUN;
+};
+
+// The free blocks of each LUN, bucketed by erase count, so that the youngest or the oldest is taken in O(log ages).
+// A bitmap marks the LUNs that have free blocks, so a LUN with free blocks is picked without visiting those without.
+class Free_Block_Pools {
+public:
+	Free_Block_Pools();
+	void add(Address const& block, int age);
+	Address take(uint package, uint die, enum age age);
+	pair<bool, pair<int, int> > pick_random_LUN(uint first_lun, uint end_lun) const;
+	uint get_num_free_blocks(uint package, uint die) const { return num_free_blocks_per_LUN[package * PACKAGE_SIZE + die]; }
+	uint get_num_free_blocks() const { return num_free_blocks; }
+	void print() const;
+    friend class boost::serialization::access;
+    template<class Archive>
+    void serialize(Archive & ar, const unsigned int version)
+    {
+    	ar & pools;
+    	ar & num_free_blocks_per_LUN;
+    	ar & luns_with_free_blocks;
+    	ar & num_free_blocks;
+    }
+private:
+	unsigned long long get_bits(uint word, uint first_lun, uint end_lun) const;
+	vector<map<int, vector<Address> > > pools;	// LUN -> erase count -> free blocks of that age
+	vector<uint> num_free_blocks_per_LUN;
+	vector<unsigned long long> luns_with_free_blocks;	// a bit per LUN, set while it has a free block
+	uint num_free_blocks;
+};
+
+// A tournament tree over the LUNs, keyed by the soonest time each could start a write: once both its channel and die
+// are free. A LUN whose register still holds the data of a read cannot take a write. The dies of a package share its
+// channel, so each package keeps a tree over its dies, and the tree over the packages takes the later of the channel's
+// finish time and the soonest die of the package. LUNs that can start as soon as each other, e.g. when their channel
+// is the bottleneck, are told apart by how long their dies have been idle. A LUN is updated in O(log LUNs) after each
+// IO it executes.
+class LUN_Availability_Tree {
+public:
+	LUN_Availability_Tree();
+	void init(Ssd* ssd);
+	void update(uint package, uint die);
+	pair<bool, pair<int, int> > find_soonest(vector<vector<Address> > const& lun_pointers) const;
+private:
+	double get_die_key(uint package, uint die) const;
+	void search_packages(uint node, vector<vector<Address> > const& lun_pointers, pair<double, double>& best_key, pair<int, int>& best) const;
+	void search_dies(uint package, uint node, double channel_finish_time, vector<vector<Address> > const& lun_pointers, pair<double, double>& best_key, pair<int, int>& best) const;
+	Ssd* ssd;
+	uint num_package_leaves;
+	uint num_die_leaves;
+	vector<pair<double, double> > package_tree;	// the soonest start time of a package's LUNs, and the finish time of their die
+	vector<vector<double> > die_trees;
 };
 
 class Block_manager_parent {
@@ -71,7 +147,7 @@ public:
 	virtual void register_read_command_outcome(Event const& event, enum status status);
 	virtual void register_read_transfer_outcome(Event const& event, enum status status);
 	virtual void register_erase_outcome(Event& event, enum status status);
-	virtual void register_register_cleared();
+	void update_LUN_availability(Address const& lun);
 	virtual Address choose_write_address(Event& write);
 	Address choose_flexible_read_address(Flexible_Read_Event* fr);
 	virtual void register_write_arrival(Event const& write);
@@ -132,7 +208,10 @@ public:
 	Address find_free_unused_block(enum age age, double time);
 	pair<bool, pair<int, int> > get_free_block_pointer_with_shortest_IO_queue(vector<vector<Address> > const& dies) const;
 	void return_unfilled_block(Address block_address, double current_time, bool give_to_block_pointers);
+	Address find_free_unused_slc_block(uint package_id, uint die_id, double time);
+	void close_unfilled_block(Address const& block_address, double time);
 	int get_num_free_blocks() const;
+	int get_num_free_blocks(int package, int die) const;
 	void print_free_blocks() const;
 protected:
 	virtual Address choose_best_address(Event& write) = 0;
@@ -141,6 +220,8 @@ protected:
 	bool can_schedule_write_immediately(Address const& prospective_dest, double current_time);
 	bool can_write(Event const& write) const;
 	Address get_free_block_pointer_with_shortest_IO_queue();
+	pair<bool, pair<int, int> > find_soonest_free_block_pointer(vector<vector<Address> > const& lun_pointers) const { return lun_availability.find_soonest(lun_pointers); }
+	Address choose_wear_leveling_address(Event& write);
 
 	inline bool has_free_pages(Address const& address) const { return address.valid == PAGE && address.page < BLOCK_SIZE; }
 
@@ -149,13 +230,11 @@ protected:
 	IOScheduler *scheduler;
 	vector<vector<Address> > free_block_pointers;
 	Migrator* migrator;
-	vector<vector<vector<deque<Address> > > > free_blocks;  // package -> die -> class -> list of such free blocks
+	Free_Block_Pools free_blocks;
 
-	int get_num_free_blocks(int package, int die) const;
 	int get_num_pointers_with_free_space() const;
 	int get_num_available_pages_for_new_writes() const { return num_available_pages_for_new_writes; }
 private:
-	Address find_free_unused_block(uint package_id, uint die_id, uint age_class, double time);
 	void issue_erase(Address a, double time);
 
 
@@ -166,19 +245,20 @@ private:
 
 	vector<Block*> all_blocks;
 
-	// The num_age_classes variable controls into how many age classes we divide blocks.
-	// In every LUN, the block manager tries to keep num_age_classes free blocks.
-	// This allows doing efficient dynamic wear-leveling by putting pages of a certain temperature in blocks of a certain age.
+	// The num_age_classes variable controls into how many age classes we divide blocks when choosing GC victims.
+	// Free blocks are kept ordered by their age instead, so writes can be put in young or old blocks for dynamic wear-leveling.
 	int num_age_classes;
 
 	uint num_free_pages;
 	uint num_available_pages_for_new_writes;
 
+	LUN_Availability_Tree lun_availability;
 	pair<bool, pair<int, int> > last_get_free_block_pointer_with_shortest_IO_queue_result;
 	bool IO_has_completed_since_last_shortest_queue_search;
 
 	vector<queue<Event*> > erase_queue;
 	vector<int> num_erases_scheduled_per_package;
+	vector<vector<Address> > wear_leveling_pointers;  // the block of each LUN that wear leveling moves cold data into
 	Wear_Leveling_Strategy* wl;
 	Garbage_Collector* gc;
 
@@ -190,10 +270,11 @@ class Wear_Leveling_Strategy {
 public:
 	Wear_Leveling_Strategy();
 	Wear_Leveling_Strategy(Ssd* ssd, Migrator*);
-	~Wear_Leveling_Strategy() {};
+	~Wear_Leveling_Strategy();
 	void register_erase_completion(Event const& event);
 	bool schedule_wear_leveling_op(Block* block);
 	double get_normalised_age(uint age) const;
+	void print() const;
     friend class boost::serialization::access;
     template<class Archive>
     void serialize(Archive & ar, const unsigned int version)
@@ -204,41 +285,59 @@ public:
     	ar & ssd;
     	ar & average_erase_cycle_time;
     	ar & blocks_being_wl;
-    	ar & blocks_to_wl;
     	ar & migrator;
 
     	ar & max_age;
     	ar & block_data;
+    	ar & youngest_blocks;
+    	ar & num_wl_ops;
+    	ar & num_wl_page_migrations;
+    	ar & last_erase_time;
     }
 private:
     void init();
 	double get_min_age() const;
-	//void update_blocks_with_min_age(uint min_age);
-	void find_wl_candidates(double current_time);
-	//set<Block*> blocks_with_min_age;
+	bool is_younger(int block_id, int other_block_id) const;
+	void sift_down(int heap_index);
+	bool is_cold(int block_id, double time) const;
+	Block* find_youngest_cold_block(double time) const;
+	void record_age_spread(double time);
 	map<int, int> age_distribution;  // maps block ages to the number of blocks with this age
 	vector<Block*> all_blocks;
 	int num_erases_up_to_date;
 	Ssd* ssd;
 	double average_erase_cycle_time;
 	set<Block*> blocks_being_wl;
-	set<Block*> blocks_to_wl;
 	Migrator* migrator;
 	int max_age;
-	MTRand_int32 random_number_generator;
 	struct Block_data {
 		int age;
 		double last_erase_time;
-		Block_data() : age(0), last_erase_time(0) {}
+		int heap_index;
+		Block_data() : age(0), last_erase_time(0), heap_index(UNDEFINED) {}
 	    friend class boost::serialization::access;
 	    template<class Archive>
 	    void serialize(Archive & ar, const unsigned int version)
 	    {
 	    	ar & age;
 	    	ar & last_erase_time;
+	    	ar & heap_index;
 	    }
 	};
 	vector<Block_data> block_data;
+	// A binary min-heap of the block IDs by age, and by last erase among blocks of the same age. An erase only ever
+	// makes a block older, so it sinks from its index, which its Block_data keeps. The oldest age is tracked as max_age.
+	vector<int> youngest_blocks;
+	long num_wl_ops;
+	long num_wl_page_migrations;
+	double last_erase_time;
+	struct age_spread {
+		double time;
+		int min_age;
+		int max_age;
+		double average_age;
+	};
+	vector<age_spread> age_spread_over_time;	// taken each time the SSD has been erased once over on average
 };
 
 // A BM that assigns each write to the die with the shortest queue. No hot-cold seperation
@@ -308,6 +407,117 @@ private:
 	map<int, vector<vector<Address> > > free_block_pointers_tags;  // tags, packages, dies
 };
 
+// Gives each write stream declared by the host its own block in every LUN, so that data with
+// similar lifetimes end up in the same blocks. At most MAX_OPEN_STREAMS streams are open at once.
+// When a write arrives for another stream, the least recently used stream is closed.
+class Block_Manager_Streams : public Block_manager_parent {
+public:
+	Block_Manager_Streams();
+	~Block_Manager_Streams() {}
+	void register_write_arrival(Event const& e);
+	void register_write_outcome(Event const& event, enum status status);
+	void register_erase_outcome(Event& event, enum status status);
+	void print() const;
+protected:
+	Address choose_best_address(Event& write);
+	Address choose_any_address(Event const& write);
+private:
+	void open_stream(int stream_id, double time);
+	void close_stream(int stream_id, double time);
+	map<int, vector<vector<Address> > > stream_pointers;  // streams, packages, dies
+	deque<int> open_streams;  // most recently used first
+	unordered_map<long, int> stream_of_lba;  // lets GC keep live pages in the stream they were written in
+	long num_stream_evictions;
+};
+
+// A BM with a pseudo-SLC write cache. Application writes go to an SLC-mode block in the die with the shortest queue,
+// and go straight to native blocks once the cache of every free die is used up. Full SLC blocks are folded
+// into native blocks in the background by garbage collecting them, oldest first, through the migrator.
+class Block_Manager_SLC_Cache : public Block_manager_parent {
+public:
+	Block_Manager_SLC_Cache();
+	~Block_Manager_SLC_Cache();
+	void init(Ssd*, FtlParent*, IOScheduler*, Garbage_Collector*, Wear_Leveling_Strategy*, Migrator*);
+	void register_write_outcome(Event const& event, enum status status);
+	void register_erase_outcome(Event& event, enum status status);
+	void print() const;
+protected:
+	Address choose_best_address(Event& write);
+	Address choose_any_address(Event const& write);
+private:
+	Block* get_block(Address const& address) const;
+	int get_cache_budget(int package, int die) const;
+	void open_slc_block(int package, int die, double time);
+	void try_to_fold(int package, int die, double time);
+	vector<vector<Address> > slc_pointers;
+	vector<vector<deque<Address> > > full_slc_blocks;  // package -> die -> full SLC blocks, oldest first
+	long num_slc_writes, num_direct_writes, num_folded_pages;
+	long num_slc_blocks_filled, num_slc_blocks_reclaimed;
+};
+
+// A BM that stripes writes over superblocks, each made of one block in every LUN. A superpage, the same page
+// in every block of the superblock, is filled before the next one, and GC reclaims whole superblocks.
+class Block_Manager_Superblocks : public Block_manager_parent {
+public:
+	Block_Manager_Superblocks();
+	~Block_Manager_Superblocks();
+	void init(Ssd*, FtlParent*, IOScheduler*, Garbage_Collector*, Wear_Leveling_Strategy*, Migrator*);
+	void register_write_outcome(Event const& event, enum status status);
+	void register_erase_outcome(Event& event, enum status status);
+	void check_if_should_trigger_more_GC(Event const& event);
+	Address choose_write_address(Event& write);
+	void print() const;
+protected:
+	Address choose_best_address(Event& write);
+	Address choose_any_address(Event const& write);
+private:
+	void open_superblock(double time);
+	bool is_superblock_full() const;
+	int get_current_superpage() const;
+	long get_num_valid_pages(vector<vector<Address> > const& superblock) const;
+	bool is_empty(vector<vector<Address> > const& superblock) const;
+	void collect_victim(double time);
+	bool remove_erased_block(vector<vector<Address> >& superblock, Address const& block);
+	vector<vector<Address> > open_pointers;
+	deque<vector<vector<Address> > > full_superblocks;
+	vector<vector<Address> > victim;
+	vector<int> superblock_of_lba;
+	int next_superblock_id, open_superblock_id;
+	long num_superblocks_opened, num_superblocks_collected, num_superblock_migrations;
+	long num_sequential_writes, num_sequential_writes_kept_together;
+};
+
+// Predicts when the data of each write will be overwritten, and puts data predicted to die around the same time
+// in the same blocks, so that blocks tend to be all dead by the time GC picks them. Lifetimes are counted in host writes.
+class Block_Manager_Lifetime_Prediction : public Block_manager_parent {
+public:
+	Block_Manager_Lifetime_Prediction();
+	~Block_Manager_Lifetime_Prediction();
+	void register_write_outcome(Event const& event, enum status status);
+	void register_erase_outcome(Event& event, enum status status);
+	void print() const;
+protected:
+	Address choose_best_address(Event& write);
+	Address choose_any_address(Event const& write);
+private:
+	struct lba_history {
+		long last_write;
+		double predicted_lifetime;
+	};
+	double predict_lifetime(Event const& write) const;
+	int get_lifetime_class(double lifetime) const;
+	pair<int, int> get_hint(Event const& write) const;
+	void open_lifetime_class(int lifetime_class, double time);
+	vector<vector<vector<Address> > > class_pointers;  // lifetime classes, packages, dies
+	vector<lba_history> history;
+	map<pair<int, int>, double> lifetime_per_hint;  // the average lifetime of the data written with a tag, stream or thread
+	double average_lifetime;
+	long num_host_writes, num_gc_writes;
+	vector<long> num_writes_per_class;
+	long num_predictions_checked, num_predictions_in_right_class;
+	double sum_of_log_errors;
+};
+
 struct pointers {
 	pointers();
 	pointers(Block_manager_parent* bm);
@@ -480,6 +690,8 @@ public:
 	Garbage_Collector(Ssd* ssd, Block_manager_parent* bm) : ssd(ssd), bm(bm), num_age_classes(bm->get_num_age_classes()) {}
 	virtual ~Garbage_Collector() {}
 	virtual void register_event_completion(Event const& event) {};
+	// Called once for each block that a range trim invalidated pages in
+	virtual void register_trimmed_block(Address const& block, Event const& trim) {};
 	virtual Block* choose_gc_victim(int package_id, int die_id, int klass) const = 0;
 	virtual void commit_choice_of_victim(Address const& phys_address, double time) = 0;
 	void set_block_manager(Block_manager_parent* b) { bm = b; }
@@ -499,7 +711,7 @@ protected:
 };
 
 // The garbage collector organizes blocks in a data structure that is convenient for choosing which block to garbage-collect next
-// This organization happens within the gc_candidates structure.
+// This organization happens within the candidate buckets.
 // Blocks that are candidates for garbage collection are first organized based on which package and die they belong to.
 // Within the each die, they are further divided how old they are (i.e. how many erases they have experienced).
 // The variable num_age_classes controls how many groups we use for blocks of different ages.
@@ -510,23 +722,123 @@ public:
 	Garbage_Collector_Greedy();
 	Garbage_Collector_Greedy(Ssd* ssd, Block_manager_parent* bm);
 	// Called by the block manager after any page in the SSD is invalidated, as a result of a trim or a write.
-	// This is used to keep the gc_candidates structure updated.
+	// This is used to keep the candidate buckets updated.
 	virtual void register_event_completion(Event const& event);
+	virtual void register_trimmed_block(Address const& block, Event const& trim);
 
 	// Called by the block manager to ask the garbage-collector for a good block to garbage-collect in a given package, die, and with a certain age.
 	Block* choose_gc_victim(int package_id, int die_id, int klass) const;
-	// Called by the block manager when a GC operation for a certain block has been issued. This block is removed from the gc_candidates structure.
+	// Called by the block manager when a GC operation for a certain block has been issued. This block is removed from the candidate buckets.
 	void commit_choice_of_victim(Address const& phys_address, double time);
 	friend class boost::serialization::access;
     template<class Archive>
     void serialize(Archive & ar, const unsigned int version)
     {
     	ar & boost::serialization::base_object<Garbage_Collector>(*this);
-    	ar & gc_candidates;
+    	ar & buckets;
+    	ar & bucket_tails;
+    	ar & lowest_bucket;
+    	ar & num_candidates;
+    	ar & is_candidate;
+    	ar & is_victim;
+    	ar & bucket_of_block;
+    	ar & next_in_bucket;
+    	ar & prev_in_bucket;
+    	ar & bucket_entry_time;
+    	ar & current_time;
     }
+protected:
+	// Called when a candidate is linked into the buckets, having been out of them, and when it leaves them
+	virtual void register_eligible_block(long block_id) {}
+	virtual void register_ineligible_block(long block_id) {}
+	Block* get_block(long block_id) const;
+	int get_lowest_bucket(int package, int die) const;
+	// For each LUN, the candidates are kept in buckets by their number of live pages. A bucket is a doubly linked list
+	// threaded through the per-block arrays below, so a block moves between buckets in constant time.
+	// A block is appended when it enters a bucket, so each bucket is ordered by when its blocks were last modified.
+	// Only fully written blocks are linked in a bucket; a candidate still being written waits until it is full.
+	vector<vector<vector<long> > > buckets;
+	vector<vector<vector<long> > > bucket_tails;
+	mutable vector<vector<int> > lowest_bucket; // no bucket of the LUN below this one holds a block
+	vector<vector<int> > num_candidates;
+	vector<bool> is_candidate;
+	vector<bool> is_victim;		// chosen for GC, and not erased yet
+	vector<int> bucket_of_block;
+	vector<long> next_in_bucket;
+	vector<long> prev_in_bucket;
+	vector<double> bucket_entry_time;
+	double current_time; // of the latest event completion
+private:
+	void add_candidate(Address const& block, double time);
+	void update_candidate(long block_id, double time);
+	void link(long block_id, int bucket, double time);
+	void unlink(long block_id);
+};
+
+// Cost-benefit picks the block with the best ratio of age times free space gained to the cost of moving its live pages,
+// (1 - u) * age / 2u, where u is the fraction of live pages and age the time since the block was last modified.
+// The oldest block of a bucket is its head, so only the head of each bucket needs to be weighed.
+class Garbage_Collector_Cost_Benefit : public Garbage_Collector_Greedy {
+public:
+	Garbage_Collector_Cost_Benefit();
+	Garbage_Collector_Cost_Benefit(Ssd* ssd, Block_manager_parent* bm);
+	Block* choose_gc_victim(int package_id, int die_id, int klass) const;
+	friend class boost::serialization::access;
+    template<class Archive>
+    void serialize(Archive & ar, const unsigned int version)
+    {
+    	ar & boost::serialization::base_object<Garbage_Collector_Greedy>(*this);
+    }
+};
+
+// Random d-choices samples GC_D_CHOICES of the fully written candidates of a LUN, and picks the one with the fewest live pages.
+// The candidates of each LUN are kept in an array, from which a block is removed by moving the last one into its place.
+class Garbage_Collector_D_Choices : public Garbage_Collector_Greedy {
+public:
+	Garbage_Collector_D_Choices();
+	Garbage_Collector_D_Choices(Ssd* ssd, Block_manager_parent* bm);
+	Block* choose_gc_victim(int package_id, int die_id, int klass) const;
+	friend class boost::serialization::access;
+    template<class Archive>
+    void serialize(Archive & ar, const unsigned int version)
+    {
+    	ar & boost::serialization::base_object<Garbage_Collector_Greedy>(*this);
+    	ar & eligible_blocks;
+    	ar & index_of_block;
+    }
+protected:
+	void register_eligible_block(long block_id);
+	void register_ineligible_block(long block_id);
+private:
+	vector<vector<vector<long> > > eligible_blocks;
+	vector<int> index_of_block;
+};
+
+// Windowed greedy picks the block with the fewest live pages among the GC_WINDOW_SIZE oldest candidates of a LUN.
+// The candidates of each LUN are kept in a list in the order they became candidates, of which the window is the front.
+class Garbage_Collector_Windowed_Greedy : public Garbage_Collector_Greedy {
+public:
+	Garbage_Collector_Windowed_Greedy();
+	Garbage_Collector_Windowed_Greedy(Ssd* ssd, Block_manager_parent* bm);
+	Block* choose_gc_victim(int package_id, int die_id, int klass) const;
+	friend class boost::serialization::access;
+    template<class Archive>
+    void serialize(Archive & ar, const unsigned int version)
+    {
+    	ar & boost::serialization::base_object<Garbage_Collector_Greedy>(*this);
+    	ar & fill_order_heads;
+    	ar & fill_order_tails;
+    	ar & next_filled;
+    	ar & prev_filled;
+    }
+protected:
+	void register_eligible_block(long block_id);
+	void register_ineligible_block(long block_id);
 private:
-	vector<long> get_relevant_gc_candidates(int package_id, int die_id, int klass) const;
-	vector<vector<set<long> > > gc_candidates;
+	vector<vector<long> > fill_order_heads;
+	vector<vector<long> > fill_order_tails;
+	vector<long> next_filled;
+	vector<long> prev_filled;
 };
 
 class Garbage_Collector_LRU : public Garbage_Collector {
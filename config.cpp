@@ -101,11 +101,19 @@ bool USE_ERASE_QUEUE = false;
  */
 int SCHEDULING_SCHEME = 2;
 
+// Static wear leveling moves cold data out of the youngest blocks once the oldest block has been erased
+// WEAR_LEVEL_THRESHOLD times more than they have
 bool ENABLE_WEAR_LEVELING = false;
 int WEAR_LEVEL_THRESHOLD = 100;
 int MAX_ONGOING_WL_OPS = 1;
+// The most wear leveling operations there may be per erase, e.g. 0.05 spends at most 5% of erases on wear leveling
+double WEAR_LEVELING_BANDWIDTH = 0.05;
 int MAX_CONCURRENT_GC_OPS = 1;
 
+// How many victim blocks a LUN may garbage-collect at once. Their page migrations take turns on the die register.
+// MAX_CONCURRENT_GC_OPS still caps the number of victims over the whole SSD.
+int MAX_CONCURRENT_GC_OPS_PER_LUN = 1;
+
 /*
  * Block manager controls how writes are allocated across the physical architecture of the device
  * 0 -> Shortest Queues - This is a simple FIFO block scheduler that assigns the next write to whichever package is free
@@ -116,6 +124,10 @@ int MAX_CONCURRENT_GC_OPS = 1;
  * 		across the logical address space. After a certain threshold of such writes, defined by the variable SEQUENTIAL_LOCALITY_THRESHOLD,
  * 		it clusters pages from the same sequential write in the same flash blocks.
  * 4 -> Round Robin
+ * 8 -> Streams - Each write stream declared by the host gets its own block in every die
+ * 9 -> SLC cache - Application writes go to SLC-mode blocks first, which are later folded into native blocks
+ * 10 -> Superblocks - Writes are striped over one block in every LUN, a page per LUN at a time, and GC reclaims such superblocks whole
+ * 11 -> Lifetime prediction - Writes whose data is predicted to be overwritten around the same time share blocks
  */
 int BLOCK_MANAGER_ID = 3;
 
@@ -123,9 +135,30 @@ int BLOCK_MANAGER_ID = 3;
  * The policy used to choose a garbage-collection victim
  * 0 -> Greedy - for each LUN, always picks the block with the least number of pages
  * 1 -> LRU -- for each LUN, always picks the block that was cleaned last
+ * 2 -> Cost-benefit - for each LUN, picks the block with the highest (1 - u) * age / 2u, u being the fraction of live pages
+ * 3 -> Random d-choices - for each LUN, picks the block with the least live pages out of GC_D_CHOICES random candidates
+ * 4 -> Windowed greedy - for each LUN, picks the block with the least live pages out of its GC_WINDOW_SIZE oldest candidates
  */
 int GARBAGE_COLLECTION_POLICY = 0;
 
+// The number of candidates the random d-choices garbage-collection policy samples
+int GC_D_CHOICES = 10;
+
+// The number of oldest candidates per LUN the windowed greedy garbage-collection policy chooses among.
+// 0 makes the window a tenth of the blocks of a LUN.
+int GC_WINDOW_SIZE = 0;
+
+// Once the host has left the SSD idle for this long (us), garbage collection cleans ahead in the background,
+// and stops starting new operations as soon as host IO arrives. 0 disables background garbage collection.
+double BACKGROUND_GC_IDLE_TIME = 0;
+
+// Background garbage collection cleans each LUN until it has this many free blocks
+int BACKGROUND_GC_FREE_BLOCKS = 8;
+
+// The most time (us) garbage collection on a LUN may pause between page migrations while host IOs wait for the LUN.
+// The budget shrinks as the LUN runs out of free blocks, so GC cannot be starved. 0 means GC is never paused.
+double GC_LATENCY_BUDGET = 0;
+
 // This parameter is special for block manager 3. If is the threshold governing when to start dedicating blocks
 // exclusively for a given sequential write
 int SEQUENTIAL_LOCALITY_THRESHOLD = 10;
@@ -144,6 +177,11 @@ int GREED_SCALE = 2;
  * 1 -> DFTL
  * 2 -> FAST
  * 3 -> LSM FTL
+ * 4 -> Compressed page FTL
+ * 5 -> Learned FTL
+ * 6 -> S-FTL
+ * 7 -> BAST
+ * 8 -> Superblock FTL
  */
 int FTL_DESIGN = 0;
 bool IS_FTL_PAGE_MAPPING = 0;
@@ -159,6 +197,68 @@ int PRINT_FILE_MANAGER_INFO = false;
 
 bool ENABLE_TAGGING = false;
 
+// The maximum number of write streams the SSD keeps open at once (block manager 8).
+// When a write arrives for a stream that is not open, the least recently used stream is closed.
+int MAX_OPEN_STREAMS = 8;
+
+/* Pseudo-SLC write cache (block manager 9)
+ * Blocks natively store BITS_PER_CELL bits per cell. A block used in SLC mode stores one bit per cell,
+ * so it only holds BLOCK_SIZE / BITS_PER_CELL pages, but a page is programmed in SLC_PAGE_WRITE_DELAY_FACTOR of the time.
+ */
+int BITS_PER_CELL = 3;
+double SLC_PAGE_WRITE_DELAY_FACTOR = 0.25;
+// The number of SLC blocks in each LUN, as a fraction of the blocks in the LUN. A dynamic cache also takes
+// half of the free blocks beyond the GC reserve, so it is large on an empty drive and shrinks as the drive fills up.
+double SLC_CACHE_SIZE = 0.05;
+bool SLC_CACHE_DYNAMIC = false;
+// Full SLC blocks are folded into native blocks once they take up this fraction of their LUN's cache.
+// With 0, every SLC block is folded in the background as soon as it is full.
+double SLC_FOLDING_THRESHOLD = 0.5;
+
+// The number of lifetime classes the lifetime prediction block manager (block manager 11) sorts writes into.
+// Each class holds lifetimes twice as long as the class below, and the longest class holds those of half the logical space or more.
+int LIFETIME_CLASSES = 4;
+
+/* Inline deduplication in the page-mapped FTL (FTL_DESIGN 0)
+ * 0 -> Disabled
+ * 1 -> Synthetic content: each write duplicates some content that is live on the SSD with probability DEDUP_RATIO
+ * 2 -> Fingerprints are hashed from the payload of the write. Writes without a payload fall back to synthetic content
+ */
+int DEDUPLICATION_MODE = 0;
+double DEDUP_RATIO = 0.3;
+
+// The size of a fingerprint in bytes (20 for SHA-1). This is only used to estimate the RAM needed by the dedup index.
+int DEDUP_FINGERPRINT_SIZE = 20;
+
+/* Compression in the compressed page FTL (FTL_DESIGN 4)
+ * Each write is compressed to a fraction of a page. Writes whose thread does not set a compressibility
+ * of its own are drawn uniformly between COMPRESSION_RATIO_MIN and COMPRESSION_RATIO_MAX.
+ * A ratio of 1 or more means the data is incompressible and is stored in a page of its own.
+ */
+double COMPRESSION_RATIO_MIN = 0.25;
+double COMPRESSION_RATIO_MAX = 0.75;
+// The time it takes the controller to decompress a packed page after it is read
+double DECOMPRESSION_DELAY = 3;
+// A packed page whose live data falls below this fraction of a page is read and its live data is repacked
+double COMPRESSION_REPACK_THRESHOLD = 0.5;
+
+// The largest distance, in physical pages, between the page a segment of the learned FTL (FTL_DESIGN 5)
+// predicts for an LBA and the page the LBA is actually on
+int LEARNED_FTL_ERROR_BOUND = 8;
+
+// S-FTL (FTL_DESIGN 6) caches a translation page whole, as runs of consecutive physical pages,
+// if the runs take no more than this fraction of the RAM its page-level entries would
+double SFTL_COMPRESSION_THRESHOLD = 0.5;
+
+// The superblock FTL (FTL_DESIGN 8) maps this many adjacent logical blocks together,
+// onto at most SUPERBLOCK_EXTRA_BLOCKS more physical blocks than that
+int SUPERBLOCK_SIZE = 8;
+int SUPERBLOCK_EXTRA_BLOCKS = 2;
+
+// The page FTL and DFTL checkpoint their map to flash after this many mapping updates, which are journaled
+// to flash in between. 0 leaves the map unpersisted.
+int MAP_CHECKPOINT_INTERVAL = 0;
+
 // This determines how reads are scheduled.
 // Recall that a read consists of two parts.
 // In the first part, a command is sent to the SSD and a read takes place in the chip.
@@ -180,6 +280,10 @@ uint MAX_ITEMS_IN_COPY_BACK_MAP = 1024;
 /* Defines the maximal length of the number of outstanding IOs that the OS can submit to the SSD  */
 int MAX_SSD_QUEUE_SIZE = 32;
 
+/* An IO that spans several pages is let into the FTL this many pages per LUN at a time.
+ * Each page IO that completes lets in the next. */
+int EXTENT_PAGES_IN_FLIGHT_PER_LUN = 2;
+
 // These are internal deadlines for scheduling IOs inside the SSD. They are in microseconds.
 int WRITE_DEADLINE = 10000000;
 int READ_DEADLINE =  10000000;
@@ -223,6 +327,8 @@ void load_entry(char *name, double value, uint line_number) {
 		MAX_ITEMS_IN_COPY_BACK_MAP = value;
 	else if (!strcmp(name, "MAX_SSD_QUEUE_SIZE"))
 		MAX_SSD_QUEUE_SIZE = value;
+	else if (!strcmp(name, "EXTENT_PAGES_IN_FLIGHT_PER_LUN"))
+		EXTENT_PAGES_IN_FLIGHT_PER_LUN = value;
 	else if (!strcmp(name, "OVER_PROVISIONING_FACTOR"))
 		OVER_PROVISIONING_FACTOR = value;
 	else if (!strcmp(name, "BLOCK_MANAGER_ID"))
@@ -231,6 +337,8 @@ void load_entry(char *name, double value, uint line_number) {
 		GREED_SCALE = value;
 	else if (!strcmp(name, "MAX_CONCURRENT_GC_OPS"))
 		MAX_CONCURRENT_GC_OPS = value;
+	else if (!strcmp(name, "MAX_CONCURRENT_GC_OPS_PER_LUN"))
+		MAX_CONCURRENT_GC_OPS_PER_LUN = value;
 	else if (!strcmp(name, "OS_SCHEDULER"))
 		OS_SCHEDULER = value;
 	else if (!strcmp(name, "GREED_SCALE"))
@@ -245,8 +353,60 @@ void load_entry(char *name, double value, uint line_number) {
 		READ_DEADLINE = value;
 	else if (!strcmp(name, "ENABLE_WEAR_LEVELING"))
 		ENABLE_WEAR_LEVELING = value;
+	else if (!strcmp(name, "WEAR_LEVELING_BANDWIDTH"))
+		WEAR_LEVELING_BANDWIDTH = value;
 	else if (!strcmp(name, "ENABLE_TAGGING"))
 		ENABLE_TAGGING = value;
+	else if (!strcmp(name, "MAX_OPEN_STREAMS"))
+		MAX_OPEN_STREAMS = value;
+	else if (!strcmp(name, "BITS_PER_CELL"))
+		BITS_PER_CELL = value;
+	else if (!strcmp(name, "SLC_PAGE_WRITE_DELAY_FACTOR"))
+		SLC_PAGE_WRITE_DELAY_FACTOR = value;
+	else if (!strcmp(name, "SLC_CACHE_SIZE"))
+		SLC_CACHE_SIZE = value;
+	else if (!strcmp(name, "SLC_CACHE_DYNAMIC"))
+		SLC_CACHE_DYNAMIC = value;
+	else if (!strcmp(name, "SLC_FOLDING_THRESHOLD"))
+		SLC_FOLDING_THRESHOLD = value;
+	else if (!strcmp(name, "LIFETIME_CLASSES"))
+		LIFETIME_CLASSES = value;
+	else if (!strcmp(name, "DEDUPLICATION_MODE"))
+		DEDUPLICATION_MODE = value;
+	else if (!strcmp(name, "DEDUP_RATIO"))
+		DEDUP_RATIO = value;
+	else if (!strcmp(name, "DEDUP_FINGERPRINT_SIZE"))
+		DEDUP_FINGERPRINT_SIZE = value;
+	else if (!strcmp(name, "COMPRESSION_RATIO_MIN"))
+		COMPRESSION_RATIO_MIN = value;
+	else if (!strcmp(name, "COMPRESSION_RATIO_MAX"))
+		COMPRESSION_RATIO_MAX = value;
+	else if (!strcmp(name, "DECOMPRESSION_DELAY"))
+		DECOMPRESSION_DELAY = value;
+	else if (!strcmp(name, "COMPRESSION_REPACK_THRESHOLD"))
+		COMPRESSION_REPACK_THRESHOLD = value;
+	else if (!strcmp(name, "LEARNED_FTL_ERROR_BOUND"))
+		LEARNED_FTL_ERROR_BOUND = value;
+	else if (!strcmp(name, "SFTL_COMPRESSION_THRESHOLD"))
+		SFTL_COMPRESSION_THRESHOLD = value;
+	else if (!strcmp(name, "SUPERBLOCK_SIZE"))
+		SUPERBLOCK_SIZE = value;
+	else if (!strcmp(name, "SUPERBLOCK_EXTRA_BLOCKS"))
+		SUPERBLOCK_EXTRA_BLOCKS = value;
+	else if (!strcmp(name, "MAP_CHECKPOINT_INTERVAL"))
+		MAP_CHECKPOINT_INTERVAL = value;
+	else if (!strcmp(name, "GARBAGE_COLLECTION_POLICY"))
+		GARBAGE_COLLECTION_POLICY = value;
+	else if (!strcmp(name, "GC_D_CHOICES"))
+		GC_D_CHOICES = value;
+	else if (!strcmp(name, "GC_WINDOW_SIZE"))
+		GC_WINDOW_SIZE = value;
+	else if (!strcmp(name, "BACKGROUND_GC_IDLE_TIME"))
+		BACKGROUND_GC_IDLE_TIME = value;
+	else if (!strcmp(name, "BACKGROUND_GC_FREE_BLOCKS"))
+		BACKGROUND_GC_FREE_BLOCKS = value;
+	else if (!strcmp(name, "GC_LATENCY_BUDGET"))
+		GC_LATENCY_BUDGET = value;
 	else
 		fprintf(stderr, "Config file parsing error on line %u:  %s   %f\n", line_number, name, value);
 	return;
@@ -371,20 +531,48 @@ void print_config(FILE *stream) {
 	fprintf(stream, "\tPAGE_SIZE:\t%u\n\n", PAGE_SIZE);
 
 	fprintf(stream, "\tMAX_SSD_QUEUE_SIZE:\t%u\n", MAX_SSD_QUEUE_SIZE);
+	fprintf(stream, "\tEXTENT_PAGES_IN_FLIGHT_PER_LUN:\t%u\n", EXTENT_PAGES_IN_FLIGHT_PER_LUN);
 	fprintf(stream, "\tOVER_PROVISIONING_FACTOR:\t%f\n", OVER_PROVISIONING_FACTOR);
 
 	fprintf(stream, "#Controller:\n");
 	fprintf(stream, "\tBLOCK_MANAGER_ID:\t%u\n", BLOCK_MANAGER_ID);
 	fprintf(stream, "\tGREED_SCALE:\t%u\n", GREED_SCALE);
 	fprintf(stream, "\tMAX_CONCURRENT_GC_OPS:\t%u\n", MAX_CONCURRENT_GC_OPS);
+	fprintf(stream, "\tMAX_CONCURRENT_GC_OPS_PER_LUN:\t%u\n", MAX_CONCURRENT_GC_OPS_PER_LUN);
 	fprintf(stream, "\tMAX_REPEATED_COPY_BACKS_ALLOWED: %i\n", MAX_REPEATED_COPY_BACKS_ALLOWED);
 	fprintf(stream, "\tMAX_ITEMS_IN_COPY_BACK_MAP: %i\n\n", MAX_ITEMS_IN_COPY_BACK_MAP);
 	fprintf(stream, "\tWRITE_DEADLINE: %i\n\n", WRITE_DEADLINE);
 	fprintf(stream, "\tREAD_DEADLINE: %i\n\n", READ_DEADLINE);
-	fprintf(stream, "\tENABLE_WEAR_LEVELING: %i\n\n", ENABLE_WEAR_LEVELING);
+	fprintf(stream, "\tENABLE_WEAR_LEVELING: %i\n", ENABLE_WEAR_LEVELING);
+	fprintf(stream, "\tWEAR_LEVELING_BANDWIDTH: %f\n\n", WEAR_LEVELING_BANDWIDTH);
+	fprintf(stream, "\tDEDUPLICATION_MODE: %i\n", DEDUPLICATION_MODE);
+	fprintf(stream, "\tDEDUP_RATIO: %f\n", DEDUP_RATIO);
+	fprintf(stream, "\tDEDUP_FINGERPRINT_SIZE: %i\n\n", DEDUP_FINGERPRINT_SIZE);
+	fprintf(stream, "\tCOMPRESSION_RATIO_MIN: %f\n", COMPRESSION_RATIO_MIN);
+	fprintf(stream, "\tCOMPRESSION_RATIO_MAX: %f\n", COMPRESSION_RATIO_MAX);
+	fprintf(stream, "\tDECOMPRESSION_DELAY: %f\n", DECOMPRESSION_DELAY);
+	fprintf(stream, "\tCOMPRESSION_REPACK_THRESHOLD: %f\n\n", COMPRESSION_REPACK_THRESHOLD);
+	fprintf(stream, "\tLEARNED_FTL_ERROR_BOUND: %i\n", LEARNED_FTL_ERROR_BOUND);
+	fprintf(stream, "\tSFTL_COMPRESSION_THRESHOLD: %f\n", SFTL_COMPRESSION_THRESHOLD);
+	fprintf(stream, "\tSUPERBLOCK_SIZE: %i\n", SUPERBLOCK_SIZE);
+	fprintf(stream, "\tSUPERBLOCK_EXTRA_BLOCKS: %i\n", SUPERBLOCK_EXTRA_BLOCKS);
+	fprintf(stream, "\tMAP_CHECKPOINT_INTERVAL: %i\n", MAP_CHECKPOINT_INTERVAL);
+	fprintf(stream, "\tGARBAGE_COLLECTION_POLICY: %i\n", GARBAGE_COLLECTION_POLICY);
+	fprintf(stream, "\tGC_D_CHOICES: %i\n", GC_D_CHOICES);
+	fprintf(stream, "\tGC_WINDOW_SIZE: %i\n", GC_WINDOW_SIZE);
+	fprintf(stream, "\tBACKGROUND_GC_IDLE_TIME: %f\n", BACKGROUND_GC_IDLE_TIME);
+	fprintf(stream, "\tBACKGROUND_GC_FREE_BLOCKS: %i\n", BACKGROUND_GC_FREE_BLOCKS);
+	fprintf(stream, "\tGC_LATENCY_BUDGET: %f\n\n", GC_LATENCY_BUDGET);
 
 	fprintf(stream, "#Open Interface:\n");
-	fprintf(stream, "\tENABLE_TAGGING: %i\n\n", ENABLE_TAGGING);
+	fprintf(stream, "\tENABLE_TAGGING: %i\n", ENABLE_TAGGING);
+	fprintf(stream, "\tMAX_OPEN_STREAMS: %i\n\n", MAX_OPEN_STREAMS);
+	fprintf(stream, "\tBITS_PER_CELL: %i\n", BITS_PER_CELL);
+	fprintf(stream, "\tSLC_PAGE_WRITE_DELAY_FACTOR: %f\n", SLC_PAGE_WRITE_DELAY_FACTOR);
+	fprintf(stream, "\tSLC_CACHE_SIZE: %f\n", SLC_CACHE_SIZE);
+	fprintf(stream, "\tSLC_CACHE_DYNAMIC: %i\n", SLC_CACHE_DYNAMIC);
+	fprintf(stream, "\tSLC_FOLDING_THRESHOLD: %f\n", SLC_FOLDING_THRESHOLD);
+	fprintf(stream, "\tLIFETIME_CLASSES: %i\n\n", LIFETIME_CLASSES);
 
 	fprintf(stream, "#Operating System:\n");
 	fprintf(stream, "\tOS_SCHEDULER: %i\n\n", OS_SCHEDULER);